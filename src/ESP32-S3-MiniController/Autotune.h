@@ -0,0 +1,161 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================== RelayAutotune ==============================
+// Relay-feedback (Astrom-Hagglund) tuning of the closed-loop speed gains.
+// The clock is switched between base + d and base - d depending on whether
+// the measured RPM is below or above the setpoint, which makes the speed
+// oscillate at the ultimate period Tu with an amplitude a. Then
+//
+//   Ku = 4 d / (pi a)      (Hz per RPM)
+//   Kp = 0.45 Ku,  Ki = 0.54 Ku / Tu      (Ziegler-Nichols PI)
+//
+// Sequence: SETTLE averages the RPM at the base clock to get the setpoint,
+// RELAY runs AUTOTUNE_CYCLES measured cycles (the first one is discarded
+// as a transient), then DONE. Anything beyond AUTOTUNE_MAX_MS from begin()
+// is FAILED, so the test time is bounded whatever the plant does.
+// All math is integer; gains come out in the SpeedPI milli-units. The class
+// only sees RPM samples and returns Hz, so a plant model can drive it too.
+class RelayAutotune
+{
+public:
+    enum State : uint8_t { AT_IDLE, AT_SETTLE, AT_RELAY, AT_DONE, AT_FAILED };
+
+    void begin(uint32_t baseHz, uint32_t relayHz, uint32_t nowMs)
+    {
+        base     = baseHz;
+        d        = relayHz;
+        startMs  = nowMs;
+        settleMs = nowMs;
+        st       = AT_SETTLE;
+        rpmSum   = 0;
+        rpmN     = 0;
+        cycles   = 0;
+        sumTuMs  = 0;
+        sumAmp   = 0;
+        lastRise = 0;
+        high     = true;
+    }
+
+    // Stop the test without a result.
+    void abort() { st = AT_FAILED; }
+
+    bool active() const { return st == AT_SETTLE || st == AT_RELAY; }
+
+    // Feed one RPM sample; returns the clock frequency to command (Hz).
+    // 'steady' is false while the clock is still ramping to the base
+    // frequency: SETTLE then restarts its averaging.
+    uint32_t update(uint32_t rpm, uint32_t nowMs, bool steady)
+    {
+        if (st == AT_SETTLE || st == AT_RELAY)
+        {
+            if (nowMs - startMs > AUTOTUNE_MAX_MS)
+                st = AT_FAILED;
+        }
+
+        if (st == AT_SETTLE)
+        {
+            if (!steady)
+            {
+                rpmSum   = 0;
+                rpmN     = 0;
+                settleMs = nowMs;
+                return base;
+            }
+            rpmSum += rpm;
+            rpmN++;
+            if (nowMs - settleMs >= AUTOTUNE_SETTLE_MS)
+            {
+                setRpm = (uint32_t)(rpmSum / rpmN);
+                if (setRpm == 0)
+                {
+                    st = AT_FAILED;
+                    return base;
+                }
+                st = AT_RELAY;
+                high = true;
+                peakMax = peakMin = rpm;
+            }
+            return base;
+        }
+
+        if (st != AT_RELAY)
+            return base;
+
+        if (rpm > peakMax) peakMax = rpm;
+        if (rpm < peakMin) peakMin = rpm;
+
+        // Relay with hysteresis around the setpoint.
+        if (high && rpm > setRpm + AUTOTUNE_HYST_RPM)
+        {
+            high = false;
+        }
+        else if (!high && rpm + AUTOTUNE_HYST_RPM < setRpm)
+        {
+            // Low -> high switch: one full cycle since the previous one.
+            high = true;
+            if (lastRise != 0)
+            {
+                if (cycles > 0)
+                {
+                    sumTuMs += nowMs - lastRise;
+                    sumAmp  += (peakMax - peakMin) / 2;
+                }
+                cycles++;
+            }
+            lastRise = nowMs;
+            peakMax = peakMin = rpm;
+
+            if (cycles > AUTOTUNE_CYCLES)
+                finish();
+        }
+
+        if (st != AT_RELAY)
+            return base;
+        return high ? base + d : (base > d ? base - d : 0);
+    }
+
+    State   state() const { return st; }
+    uint8_t cyclesDone() const { return cycles > 0 ? cycles - 1 : 0; }
+    uint32_t baseHz() const { return base; }
+    uint32_t setpointRpm() const { return setRpm; }
+
+    // Results (valid in AT_DONE).
+    uint32_t kpMilli() const { return kp; }
+    uint32_t kiMilli() const { return ki; }
+    uint32_t tuMs() const { return tu; }
+    uint32_t amplitudeRpm() const { return amp; }
+
+private:
+    void finish()
+    {
+        uint32_t n = AUTOTUNE_CYCLES;
+        amp = (uint32_t)(sumAmp / n);
+        tu  = (uint32_t)(sumTuMs / n);
+        if (amp == 0 || tu == 0)
+        {
+            st = AT_FAILED;
+            return;
+        }
+        // Ku in Hz/RPM x1000 = 4 d 1000 / (pi a), pi ~ 3142/1000.
+        uint64_t kuMilli = (4ULL * d * 1000000ULL) / (3142ULL * amp);
+        kp = (uint32_t)(kuMilli * 45 / 100);
+        ki = (uint32_t)(kuMilli * 54 / 100 * 1000 / tu);
+        st = AT_DONE;
+    }
+
+    State    st = AT_IDLE;
+    uint32_t base = 0, d = 0;     // Relay centre and half-swing (Hz)
+    uint32_t startMs = 0;         // begin(): AUTOTUNE_MAX_MS counts from here
+    uint32_t settleMs = 0;        // Start of the current SETTLE average
+    uint64_t rpmSum = 0;          // SETTLE averaging
+    uint32_t rpmN = 0;
+    uint32_t setRpm = 0;          // Relay switching point
+    bool     high = true;         // Relay output currently at base + d
+    uint32_t peakMax = 0, peakMin = 0;
+    uint32_t lastRise = 0;        // Time of the last low -> high switch
+    uint8_t  cycles = 0;          // Completed cycles (first one discarded)
+    uint64_t sumTuMs = 0, sumAmp = 0;
+    uint32_t kp = 0, ki = 0, tu = 0, amp = 0;
+};
@@ -0,0 +1,161 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================== FgCalibrator ===============================
+// Measures how many FG edges the motor gives per CLOCK pulse. The clock is
+// stepped through CAL_POINTS frequencies (1/N .. N/N of a top frequency);
+// at each, once the ramp is done and CAL_SETTLE_MS have passed, FG edges
+// and the mean clock are accumulated for CAL_MEASURE_MS, and longer if
+// needed to count CAL_MIN_EDGES (1 % count resolution). A least-squares
+// line through the origin then gives
+//
+//   k = FG edges per clock pulse = sum(x*y) / sum(x*x)   (x: Hz, y: edges/s)
+//
+// and the largest deviation of a point from that line. k is PPR divided by
+// the clock pulses per revolution, so only one of the two can be derived,
+// from the other: pprFor() when the clock pulses per rev are known (e.g. a
+// stepper driver's microstep setting), clockPerRevFor() from an entered PPR.
+//
+// Like RelayAutotune, the class only sees samples and returns Hz; the whole
+// run is bounded by CAL_MAX_MS. All math is integer.
+class FgCalibrator
+{
+public:
+    enum State : uint8_t { CAL_IDLE, CAL_RUN, CAL_DONE, CAL_FAILED };
+
+    void begin(uint32_t topHz, uint32_t nowMs)
+    {
+        top     = topHz;
+        startMs = nowMs;
+        idx     = 0;
+        st      = CAL_RUN;
+        restartPoint(nowMs);
+    }
+
+    void abort() { st = CAL_FAILED; }
+
+    bool active() const { return st == CAL_RUN; }
+
+    // Feed one RPM window: FG edges counted in it, its length, the mean
+    // clock over it. 'steady' is false while the clock still ramps.
+    // Returns the clock frequency to command (Hz).
+    uint32_t update(uint32_t pulses, uint32_t windowMs, uint32_t hz, uint32_t nowMs, bool steady)
+    {
+        if (st != CAL_RUN)
+            return top;
+        if (nowMs - startMs > CAL_MAX_MS)
+        {
+            st = CAL_FAILED;
+            return top;
+        }
+
+        if (!steady)
+        {
+            restartPoint(nowMs);
+            return pointHz(idx);
+        }
+        if (nowMs - pointMs < CAL_SETTLE_MS)
+            return pointHz(idx);
+
+        edges  += pulses;
+        hzMs   += (uint64_t)hz * windowMs;
+        spanMs += windowMs;
+        if (spanMs < CAL_MEASURE_MS || edges < CAL_MIN_EDGES)
+            return pointHz(idx);
+
+        // Point done: mean clock (Hz) and FG rate (milli-edges/s).
+        xHz[idx]  = (uint32_t)(hzMs / spanMs);
+        yMHz[idx] = (uint64_t)edges * 1000000ULL / spanMs;
+        if (xHz[idx] == 0 || yMHz[idx] == 0)
+        {
+            st = CAL_FAILED;
+            return top;
+        }
+
+        if (++idx >= CAL_POINTS)
+        {
+            fit();
+            return top;
+        }
+        restartPoint(nowMs);
+        return pointHz(idx);
+    }
+
+    State   state() const { return st; }
+    uint8_t pointsDone() const { return idx; }
+    uint32_t topHz() const { return top; }
+    uint32_t currentPointHz() const { return pointHz(idx < CAL_POINTS ? idx : CAL_POINTS - 1); }
+
+    // Results (valid in CAL_DONE).
+    // FG edges per clock pulse, x1e6.
+    uint32_t edgesPerClockPpm() const { return kPpm; }
+    // Largest deviation of a point from the fitted line (%).
+    uint32_t maxDeviationPct() const { return devPct; }
+
+    // PPR implied by 'clockPerRev' clock pulses per revolution (0 if the
+    // result is outside 1..255).
+    uint32_t pprFor(uint32_t clockPerRev) const
+    {
+        uint64_t p = ((uint64_t)kPpm * clockPerRev + 500000) / 1000000;
+        return (p >= 1 && p <= 255) ? (uint32_t)p : 0;
+    }
+
+    // Clock pulses per revolution implied by 'ppr' FG edges per revolution.
+    uint32_t clockPerRevFor(uint32_t ppr) const
+    {
+        return kPpm ? (uint32_t)(((uint64_t)ppr * 1000000 + kPpm / 2) / kPpm) : 0;
+    }
+
+private:
+    uint32_t pointHz(uint8_t i) const { return (uint32_t)((uint64_t)top * (i + 1) / CAL_POINTS); }
+
+    void restartPoint(uint32_t nowMs)
+    {
+        pointMs = nowMs;
+        edges   = 0;
+        hzMs    = 0;
+        spanMs  = 0;
+    }
+
+    void fit()
+    {
+        uint64_t sxy = 0, sxx = 0;
+        for (uint8_t i = 0; i < CAL_POINTS; i++)
+        {
+            sxy += (uint64_t)xHz[i] * yMHz[i];
+            sxx += (uint64_t)xHz[i] * xHz[i];
+        }
+        // y is in mHz, so k x1e6 = 1000 * sxy / sxx; split to stay in 64 bits.
+        kPpm = (uint32_t)((sxy / sxx) * 1000 + (sxy % sxx) * 1000 / sxx);
+        if (kPpm == 0)
+        {
+            st = CAL_FAILED;
+            return;
+        }
+
+        devPct = 0;
+        for (uint8_t i = 0; i < CAL_POINTS; i++)
+        {
+            uint64_t want = (uint64_t)kPpm * xHz[i];      // mHz x1000
+            uint64_t got  = yMHz[i] * 1000;
+            uint64_t diff = got > want ? got - want : want - got;
+            uint32_t d = (uint32_t)(diff * 100 / want);
+            if (d > devPct)
+                devPct = d;
+        }
+        st = devPct > CAL_MAX_DEV_PCT ? CAL_FAILED : CAL_DONE;
+    }
+
+    State    st = CAL_IDLE;
+    uint32_t top = 0;             // Highest calibration clock (Hz)
+    uint32_t startMs = 0;         // begin(): CAL_MAX_MS counts from here
+    uint8_t  idx = 0;             // Point being measured
+    uint32_t pointMs = 0;         // When the clock settled on it
+    uint32_t edges = 0;           // FG edges accumulated at this point
+    uint64_t hzMs = 0;            // Clock * time accumulated (Hz*ms)
+    uint32_t spanMs = 0;          // Time accumulated
+    uint32_t xHz[CAL_POINTS] = {};
+    uint64_t yMHz[CAL_POINTS] = {};
+    uint32_t kPpm = 0, devPct = 0;
+};
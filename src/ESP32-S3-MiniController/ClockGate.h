@@ -0,0 +1,50 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <esp_rom_gpio.h>
+#include <hal/gpio_ll.h>
+#include <soc/gpio_sig_map.h>
+#include <soc/gpio_struct.h>
+
+// ================================ ClockGate =================================
+// Forces the CLOCK pad low from an ISR, whatever peripheral drives it.
+// LEDC and RMT both reach the pad through the GPIO matrix; close() saves the
+// pad's output-select register and routes the pad to the plain GPIO output
+// (held low) instead, which takes effect at once: no LEDC duty update or RMT
+// queue has to drain first. open() writes the saved routing back.
+//
+//   close() : ISR-safe (register writes and a ROM call only)
+//   open()  : task context, while the backend is not being swapped
+//
+// An ISR that fires while open() runs may see the gate as still closed and
+// skip; callers re-check their fault input after open() and close() again.
+class ClockGate
+{
+public:
+    void begin(uint8_t pin) { gpio = pin; }
+
+    void IRAM_ATTR close()
+    {
+        if (closed.load(std::memory_order_acquire))
+            return;
+        saved = GPIO.func_out_sel_cfg[gpio].val;
+        gpio_ll_set_level(&GPIO, gpio, 0);
+        esp_rom_gpio_connect_out_signal(gpio, SIG_GPIO_OUT_IDX, false, false);
+        closed.store(true, std::memory_order_release);
+    }
+
+    void open()
+    {
+        if (!closed.load(std::memory_order_acquire))
+            return;
+        GPIO.func_out_sel_cfg[gpio].val = saved;
+        closed.store(false, std::memory_order_release);
+    }
+
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+
+private:
+    uint8_t           gpio = 0;
+    uint32_t          saved = 0;       // Output-select register before close()
+    std::atomic<bool> closed{false};
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// ------------------------------ ClockSetting ------------------------------
+// One LEDC timer configuration for a requested CLOCK frequency: the raw
+// divider and duty resolution to write to the timer, plus the frequency the
+// hardware really produces and its deviation from the request.
+struct ClockSetting {
+  uint32_t divQ8;         // Timer divider in Q10.8, as stored in the LEDC register
+  uint8_t  bits;          // Duty resolution (timer counts 2^bits per period)
+  uint32_t actualHz;      // Achievable frequency, rounded to the nearest Hz
+  int32_t  errorMilliHz;  // actual - requested, in mHz
+};
+
+// ------------------------------ ClockSolver -------------------------------
+// Closed-form integer solver mapping a requested frequency to an LEDC
+// divider/resolution pair. Everything is constexpr and branch-bounded, so the
+// same code yields compile-time tables and a fixed-cost runtime call.
+//
+//   f = LEDC_SRC_CLK_HZ * 256 / (divQ8 * 2^bits)
+//
+// The resolution is the smallest one that keeps the divider in range: a large
+// divider gives the finest frequency step, and 50% duty is exact at any bits.
+namespace ClockSolver
+{
+  constexpr uint64_t SRC_Q8      = (uint64_t)LEDC_SRC_CLK_HZ << 8;
+  constexpr uint32_t DIV_MIN_Q8  = 0x100;    // Divider 1.0
+  constexpr uint32_t DIV_MAX_Q8  = 0x3FFFF;  // Divider 1023.996 (10.8 bits)
+
+  // Smallest hz * 2^bits product that still fits the widest divider.
+  constexpr uint32_t MIN_PRODUCT = (uint32_t)((SRC_Q8 + DIV_MAX_Q8 - 1) / DIV_MAX_Q8);
+
+  // ceil(log2(v)) for v >= 1.
+  constexpr uint8_t ceilLog2(uint32_t v) {
+    return (v <= 1) ? 0 : (uint8_t)(32 - __builtin_clz(v - 1));
+  }
+
+  // Exact output frequency of a divider/resolution pair, in mHz.
+  constexpr uint64_t milliHzOf(uint32_t divQ8, uint8_t bits) {
+    return (SRC_Q8 * 1000ULL) / ((uint64_t)divQ8 << bits);
+  }
+
+  constexpr ClockSetting make(uint32_t hz, uint32_t divQ8, uint8_t bits) {
+    return ClockSetting{
+      divQ8,
+      bits,
+      (uint32_t)((milliHzOf(divQ8, bits) + 500) / 1000),
+      (int32_t)((int64_t)milliHzOf(divQ8, bits) - (int64_t)hz * 1000)
+    };
+  }
+
+  constexpr uint32_t clampDiv(uint64_t d) {
+    return d < DIV_MIN_Q8 ? DIV_MIN_Q8 : (d > DIV_MAX_Q8 ? DIV_MAX_Q8 : (uint32_t)d);
+  }
+
+  // Rounded divider for 'hz' at a given resolution.
+  constexpr uint32_t divFor(uint32_t hz, uint8_t bits) {
+    return clampDiv((SRC_Q8 + (((uint64_t)hz << bits) >> 1)) / ((uint64_t)hz << bits));
+  }
+
+  constexpr uint8_t clampBits(uint8_t b) {
+    return b < LEDC_MIN_BITS ? LEDC_MIN_BITS : (b > LEDC_MAX_BITS ? LEDC_MAX_BITS : b);
+  }
+
+  constexpr uint8_t bitsFor(uint32_t hz) {
+    return clampBits(ceilLog2((MIN_PRODUCT + hz - 1) / hz));
+  }
+
+  // Hardware capability of the CLOCK output at 50% duty: the top frequency
+  // uses the narrowest resolution with divider 1.0, the bottom one the widest
+  // resolution with the largest divider. Anything outside needs clamping.
+  constexpr uint32_t HW_MAX_HZ = (uint32_t)(LEDC_SRC_CLK_HZ >> LEDC_MIN_BITS);
+  constexpr uint32_t HW_MIN_HZ =
+      (uint32_t)((SRC_Q8 + ((uint64_t)DIV_MAX_Q8 << LEDC_MAX_BITS) - 1) /
+                 ((uint64_t)DIV_MAX_Q8 << LEDC_MAX_BITS));
+
+  // Solve for a non-zero frequency inside [HW_MIN_HZ, HW_MAX_HZ].
+  constexpr ClockSetting solve(uint32_t hz) {
+    return make(hz, divFor(hz, bitsFor(hz)), bitsFor(hz));
+  }
+}
+
+// Compile-time spot checks of the solver against hand-computed settings.
+static_assert(ClockSolver::solve(1000).bits == 7 && ClockSolver::solve(1000).divQ8 == 160000,
+              "1 kHz must map to 7 bits, divider 625.0");
+static_assert(ClockSolver::solve(1000).errorMilliHz == 0, "1 kHz is exactly reachable");
+static_assert(ClockSolver::solve(400000).bits == LEDC_MIN_BITS, "400 kHz runs at the narrowest resolution");
+static_assert(ClockSolver::solve(ClockSolver::HW_MIN_HZ).errorMilliHz >= 0 &&
+              ClockSolver::solve(ClockSolver::HW_MAX_HZ).errorMilliHz == 0,
+              "Both ends of the hardware range must be reachable");
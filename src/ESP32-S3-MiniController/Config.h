@@ -15,7 +15,7 @@
 // ---------------------- Motor Driver Inputs -----------------------
 // Inputs from driver for feedback and fault monitoring.
 // Inputs: IO8, IO11, IO12
-#define PIN_FG 12        // Frequency generator/tachometer input (interrupt-capable)
+#define PIN_FG 12        // Frequency generator/tachometer input (PCNT counted)
 #define PIN_LD 11        // Alarm or fault input from motor driver
 #define PIN_ENABLE 8     // Optional driver enable input
 
@@ -35,22 +35,159 @@
 // ---------------------- LEDC Clock Generator -----------------------
 // Used to generate the CLOCK signal for the motor using PWM.
 #define LEDC_CH_CLOCK 0     // LEDC channel used for the clock output
-#define LEDC_TIMER_BITS 8   // PWM resolution (8‑bit timer)
+#define LEDC_TIMER_CLOCK 0  // LEDC timer driving that channel (core maps ch/2 % 4)
+// Resolution is picked per setpoint between these bounds (see ClockSolver.h).
+#define LEDC_MIN_BITS 1     // 1 bit still gives an exact 50% duty at the top frequency
+#define LEDC_MAX_BITS 14    // Widest LEDC duty resolution on the ESP32-S3
+#define LEDC_SRC_CLK_HZ 80000000UL // APB clock feeding the LEDC timers
+
+// ---------------------- RMT Pulse Engine ---------------------------
+// Alternative CLOCK backend (per profile) for exact pulse counts and moves.
+#define RMT_PULSE_RES_HZ 10000000UL // RMT tick rate (100 ns), max output RES/2
+#define RMT_CHUNK_SYMBOLS 512       // Symbols per streamed buffer
+#define RMT_CHUNK_COUNT   4         // Buffers in flight (ring)
+#define RMT_CHUNK_MS      5         // Target duration of one buffer of pulses
+
+// ---------------------- FG Pulse Counter ---------------------------
+// FG edges are counted by a PCNT unit instead of one interrupt per edge.
+#define FG_GLITCH_NS      1000        // FG pulses shorter than this are ignored (ns)
+#define FG_PCNT_LIMIT     30000       // Hardware counter span; the driver accumulates past it
 
 // ---------------------- System Limits ------------------------------
 #define MAX_PROFILES 8       // Maximum number of stored motor control profiles
+#define CLOCK_CAP_MIN_HZ 1000 // Lowest clock cap (maxClockHz) a profile may hold
 
 // ---------------------- UI and Input Timing ------------------------
 // Long‑press detection threshold for buttons.
 #define LONG_PRESS_MS 600    // Duration (ms) to consider a SELECT long press
 
-// RPM sampling window for tachometer processing.
-#define RPM_SAMPLE_MS 1000   // Window (ms) for RPM measurement averaging
+// RPM sampling window for tachometer processing. The window is adaptive:
+// it closes once it holds RPM_MIN_PULSES FG edges (at least one revolution)
+// and RPM_MIN_WINDOW_MS have passed, or after RPM_SAMPLE_MS at the latest.
+#define RPM_SAMPLE_MS 1000   // Longest RPM window (ms); also the telemetry period
+#define RPM_MIN_WINDOW_MS 50 // Shortest RPM window (ms)
+#define RPM_MIN_PULSES 8     // FG edges wanted per estimate (raised to PPR)
+// Below FG_PERIOD_MAX_HZ edges/s the RPM comes from the FG edge period
+// (edge interrupt timestamps); above it from the PCNT edge count.
+#define FG_PERIOD_MAX_HZ   2000  // Period -> count switch (count -> period at 3/4)
+#define FG_ZERO_TIMEOUT_MS 1000  // No FG edge for this long reads as 0 RPM
+#define FG_EDGE_RING       512   // FG edge timestamps buffered ISR -> loop (power of 2)
+// Period-mode windows also give the spread of the edge intervals (see
+// PeriodStats.h). It includes the pole spacing error of the FG magnet, so
+// the wear threshold is best set per motor family.
+#define FG_JITTER_MIN_PERIODS   8   // Intervals a window needs to count
+#define FG_JITTER_MIN_WINDOWS   10  // Windows a run needs for a verdict
+#define FG_JITTER_WORN_PERMILLE 60  // Mean interval CV (per mille) flagged as worn
+
+// ---------------------- RPM Filter --------------------------------
+// Optional fixed-point filter chain on the RPM estimate (see RpmFilter.h),
+// set per profile; these are the defaults for new profiles.
+#define RPM_FILT_MAX_N     15    // Longest median / moving-average window
+#define RPM_FILT_STAGES    0     // RpmFilterStage mask; 0 = raw RPM
+#define RPM_FILT_MEDIAN_N  5     // Median window (samples)
+#define RPM_FILT_AVG_N     4     // Moving-average window (samples)
+#define RPM_FILT_IIR_ALPHA 64    // IIR weight of a new sample (/256)
 
 // ---------------------- Acceleration Ramp -------------------------
-// Smooth ramp applied when starting or changing target speed.
-#define RAMP_STEP_HZ    50       // Hz increment per ramp tick
-#define RAMP_INTERVAL_MS 20      // Time (ms) between ramp ticks
+// Jerk-limited S-curve applied when starting or changing target speed.
+// Start frequency and accel/decel are per profile; these are the defaults.
+#define RAMP_START_HZ    50       // Clock jumps to this on start (and cuts from it on stop)
+#define RAMP_ACCEL_HZ_S  2500     // Acceleration limit (Hz per second)
+#define RAMP_DECEL_HZ_S  2500     // Deceleration limit (Hz per second)
+#define RAMP_JERK_HZ_S2  25000    // Jerk limit (Hz per second^2); 0 = linear ramp
+#define RAMP_RATE_MIN_HZ_S 100    // Accel/decel range a profile may hold (Hz/s)
+#define RAMP_RATE_MAX_HZ_S 100000
+
+// ---------------------- Closed-Loop Speed -------------------------
+// Default PI gains for new profiles (x1000: Hz per RPM, Hz per RPM*s).
+#define SPEED_KP_MILLI   200      // 0.200 Hz per RPM of error
+#define SPEED_KI_MILLI   500      // 0.500 Hz per RPM of error per second
+#define SPEED_GAIN_MAX_MILLI 50000 // Kp/Ki range a profile may hold (0 .. 50.000)
+#define RPM_STEP         100      // UP/DOWN step of the RPM setpoint
+
+// ---------------------- Speed-Loop Autotune -----------------------
+// Relay-feedback test that derives the PI gains (see Autotune.h): the clock
+// is switched +/- AUTOTUNE_RELAY_PCT around its base while the RPM oscillates.
+#define AUTOTUNE_RELAY_PCT  10    // Relay half-swing, % of the base clock
+#define AUTOTUNE_HYST_RPM   20    // Relay hysteresis around the setpoint (RPM)
+#define AUTOTUNE_CYCLES     4     // Oscillation cycles averaged for the result
+#define AUTOTUNE_SETTLE_MS  3000  // RPM averaged this long for the setpoint
+#define AUTOTUNE_SAMPLE_MS  200   // Longest RPM window while tuning (ms)
+#define AUTOTUNE_MAX_MS     60000 // Test aborted if not finished by then
+
+// ---------------------- FG Calibration ----------------------------
+// Menu -> Calibrate FG steps the clock through CAL_POINTS speeds up to the
+// current target and fits FG edges per clock pulse (see Calibrate.h).
+#define CAL_POINTS       4        // Clock steps (1/N .. N/N of the target)
+#define CAL_SETTLE_MS    1000     // Wait after the ramp at each step
+#define CAL_MEASURE_MS   2000     // FG edges counted this long at each step
+#define CAL_MIN_EDGES    100      // ...and at least this many
+#define CAL_SAMPLE_MS    200      // Longest RPM window while calibrating
+#define CAL_MAX_DEV_PCT  5        // Worst point off the fitted line (%)
+#define CAL_MAX_MS       60000    // Calibration aborted if not finished by then
+
+// ---------------------- Frequency Sweep ---------------------------
+// Menu -> Sweep curve steps the clock from the profile start Hz to its
+// max clock and stores settled RPM and ripple per step (see Sweep.h).
+#define SWEEP_POINTS      16      // Steps, and points in the stored curve
+#define SWEEP_SETTLE_MS   1000    // Wait after the ramp at each step
+#define SWEEP_MEASURE_MS  1500    // RPM collected this long at each step
+#define SWEEP_SAMPLE_MS   100     // Longest RPM window while sweeping
+#define SWEEP_PULLOUT_PCT 30      // Step this far below the RPM/Hz line = pull-out
+#define SWEEP_MAX_MS      120000  // Sweep aborted if not finished by then
+
+// ---------------------- Resonance Skip Bands ----------------------
+// Clock bands the motor resonates in, stored per profile (see SkipBands.h).
+// The ramp crosses them in one step and the UP/DOWN setpoint skips them.
+// They come from a sweep curve (ripple) or, below FG_PERIOD_MAX_HZ, from
+// the live FG period spread.
+#define SKIP_MAX_BANDS       3    // Bands per profile
+#define SKIP_RIPPLE_PCT      8    // Sweep step ripple (% of its RPM) to be resonant ...
+#define SKIP_RIPPLE_X        3    // ... and at least this many times the median ripple
+#ifndef SKIP_LIVE_DETECT          // May come from the build (the host tests try both)
+#define SKIP_LIVE_DETECT     0    // 1: also learn bands while running (saved with the profile)
+#endif
+#define SKIP_LIVE_SPREAD_PCT 40   // FG period spread (max - min, % of mean) to count
+#define SKIP_LIVE_MS         3000 // Spread held this long at a steady clock
+#define SKIP_LIVE_BAND_PCT   5    // Learned band: clock +/- this %
+
+// ---------------------- Slip / Stall Detection ---------------------
+// The measured RPM is compared with the RPM the clock should give (profile
+// clock pulses per rev, or a ratio learned while running; see SlipMonitor.h).
+#define SLIP_WARN_PCT        15    // Slip (%) shown as a warning
+#define SLIP_DERATE_PCT      30    // Slip (%) that opens the loop and cuts the clock
+#define SLIP_STOP_PCT        60    // Slip (%) treated as a stall: motor stopped
+#define SLIP_HYST_PCT        5     // A tier clears this far below its threshold
+#define SLIP_TRIP_SAMPLES    2     // Consecutive samples needed to enter a tier
+#define SLIP_DERATE_KEEP_PCT 70    // Derate: target cut to this % of the clock
+#define SLIP_WINDOW_MS       150   // Longest RPM window while slip is checked
+#define SLIP_GRACE_MS        500   // No check right after a start (ms)
+#define SLIP_MIN_RPM         10    // No check below this expected speed
+#define SLIP_LEARN_MS        2000  // Steady running needed to learn the ratio
+#define SLIP_CLOCK_REV_MAX   60000 // Clock pulses per rev a profile may hold
+
+// ---------------------- FG Edge Watchdog ---------------------------
+// Checked every motion tick while running: FG is declared lost (motor cut)
+// when no edge arrives within FG_WD_PERIODS expected FG periods at the
+// current clock. Needs a known clock-to-RPM ratio (profile, learned, or
+// the last steady reading).
+#define FG_WD_PERIODS    4        // Deadline in expected FG edge periods
+#define FG_WD_MIN_MS     5        // Shortest deadline (ms)
+#define FG_WD_MAX_MS     1000     // Longest deadline (ms)
+
+// ---------------------- Motion Tick -------------------------------
+// Ramp, start timeout and RMT buffer refill run from a periodic esp_timer
+// callback, so their timing does not depend on how long loop() takes.
+#define MOTION_TICK_US   1000     // Motion tick period (us)
+#define RAMP_MAX_DT_US   50000    // Longest gap integrated in one ramp step (us)
+
+// ---------------------- Direction Reversal ----------------------
+// A running motor is slowed to REVERSAL_HZ, the clock is paused just long
+// enough to flip DIR with these margins around the CLOCK edges, and the
+// ramp then takes it back to the target speed in the new direction.
+#define REVERSAL_HZ      100      // Speed at which DIR is flipped (Hz)
+#define DIR_HOLD_US      50       // DIR held after the last CLOCK edge (us)
+#define DIR_SETUP_US     50       // DIR settled before the next CLOCK edge (us)
 
 // ---------------------- Start Timeout ---------------------------
 // If no RPM is detected within this window after starting, motor is cut.
@@ -63,11 +200,28 @@
 #define ADMIN_DEFAULT_PW "1234"  // Shown only if no password has been set yet
 #define ADMIN_PW_MAX_LEN 8       // Max length of admin password
 
+// ---------------------- Telemetry ---------------------------------
+// Settings -> Telemetry: off, a text line every RPM_SAMPLE_MS, or binary
+// records (see TelemetryFrame.h). Binary records are taken in the motion
+// tick at TELEM_RATE_HZ and sent from loop() as serial room allows. A
+// frame is 26 bytes: 115200 baud UART carries about 440 per second, USB
+// CDC the full tick rate. Debug prints would corrupt frames, which the
+// decoder then drops.
+#define TELEM_RATE_HZ    200      // Binary records per second (divides the tick rate)
+#define TELEM_RING       64       // Records buffered tick -> loop() (power of 2)
+
+enum TelemetryMode : uint8_t
+{
+    TELE_OFF    = 0,
+    TELE_TEXT   = 1,   // Text line (RPM_SAMPLE_MS)
+    TELE_BINARY = 2    // COBS/CRC16 records (TELEM_RATE_HZ)
+};
+
 // ---------------------- Debug Flags -------------------------------
 // Set any of these to 1 to enable verbose serial debug output.
 #define DEBUG_BUTTONS 0
 #define DEBUG_MOTOR 0
-#define DEBUG_SPEED 1
+#define DEBUG_SPEED 0
 
 // ---------------------- Language Selection ------------------------
 // Supported UI languages.
@@ -121,11 +121,10 @@ void loop()
     // Poll inputs and generate one-shot events (edges and long-press).
     buttons.poll();
 
-    // Periodically sample tachometer and update RPM (uses RPM_SAMPLE_MS window).
+    // Sample tachometer and update RPM (adaptive window, RPM_SAMPLE_MS at most).
     motor.sampleRPM();
 
-    // Process acceleration/deceleration ramp and start-timeout watchdog.
-    motor.updateRamp();
+    // Ramp and start-timeout watchdog run from the motor's own timer tick.
 
     // Drive the UI state machine: rendering, menu navigation, and actions.
     ui.loop();
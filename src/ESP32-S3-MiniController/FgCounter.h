@@ -0,0 +1,97 @@
+#pragma once
+#include <Arduino.h>
+#include <driver/pulse_cnt.h>
+#include "Config.h"
+
+// ================================ FgCounter =================================
+// Counts FG (tachometer) rising edges with a PCNT unit, so the CPU takes no
+// interrupt per edge. The glitch filter drops pulses shorter than
+// FG_GLITCH_NS. The 16-bit hardware counter wraps at FG_PCNT_LIMIT; with
+// accum_count the driver folds each wrap into the value it reports, which
+// costs one interrupt per FG_PCNT_LIMIT edges.
+//
+// count() is a free-running total: callers take differences between two
+// reads, which are exact across wraps of the 32-bit result as well.
+class FgCounter
+{
+public:
+    // Attach a PCNT unit to 'pin'. The pin keeps the pull-up set by pinMode().
+    // Returns false if no unit/channel is free.
+    bool begin(uint8_t pin)
+    {
+        if (unit)
+            return true;
+
+        pcnt_unit_config_t ucfg = {};
+        ucfg.low_limit  = -1;
+        ucfg.high_limit = FG_PCNT_LIMIT;
+        ucfg.flags.accum_count = 1;
+        if (pcnt_new_unit(&ucfg, &unit) != ESP_OK)
+        {
+            unit = nullptr;
+            return false;
+        }
+
+        pcnt_glitch_filter_config_t fcfg = {};
+        fcfg.max_glitch_ns = FG_GLITCH_NS;
+        pcnt_unit_set_glitch_filter(unit, &fcfg);
+
+        pcnt_chan_config_t ccfg = {};
+        ccfg.edge_gpio_num  = pin;
+        ccfg.level_gpio_num = -1;
+        if (pcnt_new_channel(unit, &ccfg, &chan) != ESP_OK)
+        {
+            pcnt_del_unit(unit);
+            unit = nullptr;
+            chan = nullptr;
+            return false;
+        }
+
+        // Rising edge counts, falling edge is ignored.
+        pcnt_channel_set_edge_action(chan, PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                     PCNT_CHANNEL_EDGE_ACTION_HOLD);
+
+        // The watch point on the limit is what lets the driver accumulate.
+        pcnt_unit_add_watch_point(unit, FG_PCNT_LIMIT);
+
+        pcnt_unit_enable(unit);
+        pcnt_unit_clear_count(unit);
+        pcnt_unit_start(unit);
+        base = 0;
+        return true;
+    }
+
+    bool active() const { return unit != nullptr; }
+
+    // Rising edges seen since begin() (modulo 2^32).
+    uint32_t count()
+    {
+        int v = 0;
+        pcnt_unit_get_count(unit, &v);
+
+        // Keep the driver's int accumulator far from overflow. An edge that
+        // lands between the read and the clear is lost, once every 2^30 edges.
+        if (v >= (1 << 30))
+        {
+            pcnt_unit_clear_count(unit);
+            base += (uint32_t)v;
+            v = 0;
+        }
+        return base + (uint32_t)v;
+    }
+
+    // Current hardware total, without the rebase done by count(). Only a
+    // change indicator for another context (the FG watchdog): it never
+    // clears the unit, so it does not race with count().
+    int raw() const
+    {
+        int v = 0;
+        pcnt_unit_get_count(unit, &v);
+        return v;
+    }
+
+private:
+    pcnt_unit_handle_t    unit = nullptr;
+    pcnt_channel_handle_t chan = nullptr;
+    uint32_t              base = 0;   // Edges folded in by earlier clears
+};
@@ -1,13 +1,59 @@
 #pragma once
 #include <Arduino.h>
 #include <Preferences.h>
+#include <atomic>
+#include <driver/ledc.h>
+#include <esp_timer.h>
 #include "Config.h"
+#include "ClockSolver.h"
+#include "PulseEngine.h"
+#include "ClockGate.h"
+#include "FgCounter.h"
+#include "SpscRing.h"
+#include "TelemetryFrame.h"
+#include "RpmFilter.h"
+#include "SlipMonitor.h"
+#include "PeriodStats.h"
+#include "Ramp.h"
+#include "SpeedLoop.h"
+#include "Autotune.h"
+#include "Calibrate.h"
+#include "Sweep.h"
+#include "SkipBands.h"
 #include "Profiles.h"
 
 // Simple, header-only max helper to avoid <algorithm> on embedded targets.
 template <typename T>
 T simple_max(T a, T b) { return (a > b) ? a : b; }
 
+// FG edges drained from the ISR ring over one RPM window (period mode).
+struct EdgeWindow
+{
+    uint32_t n;           // Edges in the window
+    uint32_t firstUs;     // Timestamp of the first edge
+    uint32_t lastUs;      // Timestamp of the last edge
+    PeriodStats period;   // Edge-to-edge intervals: min, max, mean, variance
+    bool     dropped;     // Ring overflowed: some edges are missing
+};
+
+// One RPM estimate as handed to the UI, telemetry and the stall logic.
+struct RpmReading
+{
+    uint32_t rpmX10;      // Speed in tenths of RPM
+    uint32_t atMs;        // millis() when the estimate was taken
+    uint8_t  confidence;  // 0..100, see MotorRuntime::measureRpm()
+};
+
+// Record of the LD trips latched by the LD interrupt (a snapshot, see
+// MotorRuntime::ldFault()).
+struct LdFault
+{
+    uint32_t count;       // Trips since boot
+    int64_t  atUs;        // esp_timer time of the last trip
+    uint32_t hz;          // Clock frequency at that moment
+    uint32_t rpmX10;      // Last measured speed at that moment
+};
+
 class MotorRuntime
 {
 public:
@@ -20,30 +66,54 @@ public:
         pinMode(PIN_STOP,   OUTPUT);     // Optional stop line
 
         pinMode(PIN_ENABLE, INPUT_PULLUP); // Optional enable input (changed from output)
-        pinMode(PIN_FG,     INPUT_PULLUP); // Tachometer input (FG), active edge = RISING
+        pinMode(PIN_FG,     INPUT_PULLUP); // Tachometer input (FG), counted edge = RISING
         pinMode(PIN_LD,     INPUT_PULLUP); // Fault/alarm input (LD), polarity set by profile
 
         // ---------------- LEDC clock setup ----------------
-        // Attach LEDC (ESP32 PWM) to PIN_CLOCK with an initial frequency and resolution.
-        // We start at 1 kHz and 8-bit resolution, but reattach dynamically in setClock().
-        ledcAttach(PIN_CLOCK, 1000, LEDC_TIMER_BITS);
-        ledcWrite(PIN_CLOCK, 0);         // Duty 0% (motor stopped)
-
-        // ---------------- Tachometer ISR ------------------
-        // Count FG pulses on rising edge to compute RPM periodically.
-        attachInterrupt(digitalPinToInterrupt(PIN_FG), isrFG, RISING);
+        // LEDC is the default CLOCK backend; applyProfile() swaps in the RMT
+        // pulse engine for profiles that ask for it.
+        attachLedcClock();
+        clockGate.begin(PIN_CLOCK);
+
+        // ---------------- Ramp planner --------------------
+        // Defaults until applyProfile() loads the profile's own limits.
+        ramp.configure(RAMP_ACCEL_HZ_S, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2);
+
+        // ---------------- Motion tick ---------------------
+        // Ramp, start timeout and RMT refill run from a periodic esp_timer
+        // callback; loop() only posts requests (see post()).
+        esp_timer_create_args_t targs = {};
+        targs.callback        = onTick;
+        targs.arg             = this;
+        targs.dispatch_method = ESP_TIMER_TASK;
+        targs.name            = "motion";
+        esp_timer_create(&targs, &tickTimer);
+        esp_timer_start_periodic(tickTimer, MOTION_TICK_US);
+
+        // ---------------- Tachometer counter --------------
+        // FG rising edges are counted by a PCNT unit (glitch filtered, no
+        // interrupt per edge). The per-edge ISR is only a fallback for when
+        // no counter unit can be claimed.
+        // The ISR is also what timestamps edges for period measurement.
+        // Either count runs free, so the first window starts from its value.
+        fgHw = fgCounter.begin(PIN_FG);
+        if (!fgHw)
+            setFgEdgeIsr(true);
+        lastFgCount = fgHw ? fgCounter.count() : (uint32_t)fgPulses;
 
         // ---------------- System settings (NVS) -----------
         // Load persisted telemetry and language preferences.
         sysPrefs.begin("sys", false);
-        telemetryOn = sysPrefs.getBool("tele", false);
+        // "telm" replaced the on/off "tele" key, which still seeds it.
+        teleMode = sysPrefs.getUChar("telm", sysPrefs.getBool("tele", false) ? TELE_TEXT : TELE_OFF);
         lang = (Language)sysPrefs.getUChar("lang", (uint8_t)LANG_ES);
         sysPrefs.end();
 
 #if DEBUG_MOTOR
         Serial.println("Motor initialized");
         Serial.print("Telemetry: ");
-        Serial.println(telemetryOn ? "ON" : "OFF");
+        Serial.println(teleMode == TELE_TEXT ? "TEXT" : teleMode == TELE_BINARY ? "BINARY" : "OFF");
+        Serial.println(fgHw ? "FG: PCNT" : "FG: ISR (no PCNT unit)");
 #endif
     }
 
@@ -51,13 +121,44 @@ public:
     // Resets runtime flags and targets to safe defaults.
     void applyProfile(const MotorProfile &p)
     {
+        // Hold the motion tick while the backend is swapped under it, then
+        // silence the clock of the previous profile.
+        parkTick();
+        setLdIsr(false);
+        clockGate.open();
+        ldTrip             = false;
+        pendingReq         = 0;
+        moveActive         = false;
+        rampActive         = false;
+        stopping           = false;
+        startTimeoutActive = false;
+        setClock(0);
+        selectBackend((PulseBackend)p.pulseBackend);
+
         prof     = p;
+        ramp.configure(prof.accelHzS, prof.decelHzS, RAMP_JERK_HZ_S2);
+        speedPi.configure(prof.kpMilli, prof.kiMilli);
+        rpmFilter.configure(prof.rpmFilter, prof.filtMedianN, prof.filtAvgN, prof.filtIirAlpha);
+        slip.configure(prof.clockPerRev);
+        fgWdRatioQ16 = 0;
+        fgLossFired = false;
+        jitterRun.reset();
+        slipRun = false;
+        slipStallFired = false;
+        closedLoop = false;
+        autotuning = false;
+        calibrating = false;
+        sweeping = false;
+        rpmWindowMs = RPM_SAMPLE_MS;
         dirCW    = true;
+        dirApplied = true;
         brakeOn  = false;
         enabled  = true;
         running  = false;
         targetHz = 1000;       // Default target clock (Hz)
         applyOutputs();
+        setLdIsr(prof.hasLD);
+        resumeTick();
 
 #if DEBUG_MOTOR
         Serial.print("Profile applied: ");
@@ -66,20 +167,22 @@ public:
     }
 
     // Push current runtime control state to hardware pins, honoring profile options:
-    //  - Direction line always active
+    //  - Direction line always active (the motion tick latches dirCW into it
+    //    only while the clock is stopped, see dirApplied)
     //  - Brake/Stop only if present in profile, with correct active polarity
     //  - Enable is now an INPUT, so we read it instead of writing to it
     void applyOutputs()
     {
-        digitalWrite(PIN_DIR, dirCW ? HIGH : LOW);
+        digitalWrite(PIN_DIR, dirApplied ? HIGH : LOW);
 
         if (prof.hasBrake)
             digitalWrite(PIN_BRAKE, brakeOn ? HIGH : LOW);
 
         if (prof.hasStop)
         {
-            // When not running, assert STOP according to profile polarity.
-            bool active = !running;
+            // When not running (and not still ramping down), assert STOP
+            // according to profile polarity.
+            bool active = !running && !stopping;
             bool level = prof.stopActiveHigh ? active : !active;
             digitalWrite(PIN_STOP, level ? HIGH : LOW);
         }
@@ -93,132 +196,270 @@ public:
         }
     }
 
-    // Start the motor using ramp acceleration from 0 to targetHz.
+    // Start the motor: jump to the profile start Hz, then S-curve up to targetHz.
+    // The motion tick does the work (see beginRun()).
     void start()
     {
-        running = true;
-        startTimeoutFired  = false;
+        // Closed loop: the ramp heads for the last commanded frequency and
+        // the PI controller takes over from there.
+        if (closedLoop)
+            speedPi.reset(targetHz);
 
-        // Begin ramp from zero
-        rampCurrentHz      = 0;
-        rampActive         = true;
-        lastRampTick       = millis();
-
-        // Arm start timeout (only meaningful when profile has FG)
-        if (prof.hasFG)
+        // A driver fault that is still asserted would trip again at once.
+        if (prof.hasLD && ldAsserted())
         {
-            startTimeoutActive = true;
-            startTimeoutStart  = millis();
+#if DEBUG_MOTOR
+            Serial.println("LD asserted - start refused");
+#endif
+            return;
         }
 
-        // Apply clock at 0 so LEDC is attached; ramp will raise it
-        setClock(0);
-        applyOutputs();
+        running = true;
+        post(REQ_START);
 
 #if DEBUG_MOTOR
         Serial.print("Motor STARTED (ramping to ");
-        Serial.print(targetHz);
+        Serial.print(targetHz.load());
         Serial.println(" Hz)");
 #endif
     }
 
-    // Stop the motor with a deceleration ramp, then cut clock.
+    // Stop the motor according to the profile's stop mode: STOP_CUT cuts
+    // the clock at once; the ramped modes decelerate to zero first, then
+    // assert STOP (and engage the brake for STOP_RAMP_BRAKE). isStopping()
+    // is true meanwhile, and stopTimeMs() reports how long it took.
     void stop()
     {
-        // Cancel start-timeout monitoring
-        startTimeoutActive = false;
+        // A positioned move is cut short with its own deceleration; the
+        // motor counts as running until the tick sees the last pulse leave.
+        if (moveActive)
+        {
+            post(REQ_HALT);
+            return;
+        }
 
-        // If currently ramping up, stop the ramp immediately
-        rampActive    = false;
-        rampCurrentHz = 0;
+        running = false;
+        post(prof.stopMode == STOP_CUT ? REQ_HALT : REQ_DECEL);
+
+#if DEBUG_MOTOR
+        Serial.println(prof.stopMode == STOP_CUT ? "Motor STOPPED" : "Motor stopping (ramp)");
+#endif
+    }
 
+    // Emergency stop: cut the clock at the next tick whatever the stop mode,
+    // a ramp in progress or a positioned move, assert STOP and engage the
+    // brake if the profile has one.
+    void emergencyStop()
+    {
         running = false;
-        setClock(0);
-        applyOutputs();
+        post(REQ_ESTOP);
 
 #if DEBUG_MOTOR
-        Serial.println("Motor STOPPED");
+        Serial.println("EMERGENCY STOP");
 #endif
     }
 
+    // True while a ramped stop is still decelerating.
+    bool isStopping() const { return stopping; }
+
+    // Duration of the last stop, from the request being taken up by the
+    // motion tick to the clock reaching 0 (ms).
+    uint32_t stopTimeMs() const { return lastStopMs; }
+
     // Configure the LEDC clock frequency and duty cycle.
-    // Re-attaches LEDC with the requested frequency to minimize jitter.
+    // Called from the motion tick only (or from loop() while it is parked).
+    // The divider/resolution pair comes from ClockSolver (fixed-cost integer
+    // math) and is written straight to the running timer; the hardware latches
+    // it at the next timer overflow, so the pulse train stays continuous.
+    // Duty is rewritten only when the resolution changes or the output was gated.
     void setClock(uint32_t hz)
     {
         if (hz == 0)
         {
             // Duty 0% to ensure no pulses; keep last configured frequency irrelevant.
-            ledcWrite(PIN_CLOCK, 0);
+            writeClockDuty(0);
+            clockGated = true;
             currentHz = 0;
             return;
         }
 
-        // Enforce profile limit.
+        // Enforce profile limit and the real backend range, recording any clamp.
+        uint32_t requested = hz;
+        ClampReason reason = CLAMP_NONE;
         if (hz > prof.maxClockHz)
+        {
             hz = prof.maxClockHz;
+            reason = CLAMP_PROFILE;
+        }
+        if (hz > hwMaxHz())
+        {
+            hz = hwMaxHz();
+            reason = CLAMP_HW_MAX;
+        }
+        else if (hz < hwMinHz())
+        {
+            hz = hwMinHz();
+            reason = CLAMP_HW_MIN;
+        }
+        if (reason != CLAMP_NONE)
+        {
+            clampReason      = reason;
+            clampRequestedHz = requested;
+            clampCount++;
+        }
+
+        if (backend == PULSE_RMT)
+        {
+            // Pulse engine: new period applies from the next generated chunk.
+            rmt.setFrequency(hz);
+            clockGated = false;
+            currentHz = hz;
+            return;
+        }
+
+        ClockSetting cs = ClockSolver::solve(hz);
+        if (cs.divQ8 != clockSetting.divQ8 || cs.bits != clockSetting.bits)
+        {
+            ledc_timer_set(LEDC_LOW_SPEED_MODE, (ledc_timer_t)LEDC_TIMER_CLOCK,
+                           cs.divQ8, cs.bits, LEDC_APB_CLK);
+        }
+
+        if (clockGated || cs.bits != clockSetting.bits)
+        {
+            writeClockDuty(1u << (cs.bits - 1)); // 50% duty at this resolution
+            clockGated = false;
+        }
 
-        // Reconfigure LEDC to the new frequency with the chosen resolution.
-        // Note: ledcDetach/Attach pattern avoids artifacts when changing freq.
-        ledcDetach(PIN_CLOCK);
-        ledcAttach(PIN_CLOCK, hz, LEDC_TIMER_BITS);
-        ledcWrite(PIN_CLOCK, 128); // ~50% duty with 8-bit resolution
+        clockSetting = cs;
         currentHz = hz;
 
 #if DEBUG_MOTOR
         Serial.print("Clock set to ");
         Serial.print(hz);
-        Serial.println(" Hz");
+        Serial.print(" Hz (actual ");
+        Serial.print(cs.actualHz);
+        Serial.print(" Hz, err ");
+        Serial.print(cs.errorMilliHz);
+        Serial.print(" mHz, ");
+        Serial.print(cs.bits);
+        Serial.println(" bits)");
 #endif
     }
 
+    // Quantization error of the active setpoint (achieved - requested), in mHz.
+    // The RMT engine carries sub-tick remainders, so its mean error is 0.
+    int32_t clockErrorMilliHz() const
+    {
+        return (clockGated || backend == PULSE_RMT) ? 0 : clockSetting.errorMilliHz;
+    }
+
+    // Duty resolution currently used by the CLOCK timer.
+    uint8_t clockBits() const { return clockSetting.bits; }
+
+    // Highest setpoint allowed for the active profile on this hardware.
+    uint32_t clockLimitHz() const
+    {
+        return prof.maxClockHz < hwMaxHz() ? prof.maxClockHz : hwMaxHz();
+    }
+
+    // Frequency range of the active CLOCK backend.
+    uint32_t hwMaxHz() const { return backend == PULSE_RMT ? RmtPulseEngine::MAX_HZ : ClockSolver::HW_MAX_HZ; }
+    uint32_t hwMinHz() const { return backend == PULSE_RMT ? RmtPulseEngine::MIN_HZ : ClockSolver::HW_MIN_HZ; }
+
+    // ---------------------- Positioned moves (RMT only) ----------------
+    // Emit exactly 'pulses' CLOCK pulses from standstill: up from startHz
+    // with the profile's acceleration, at most to targetHz, and back down
+    // with its deceleration so the last pulse ends the move. Needs the RMT
+    // backend and a stopped motor. Returns false, with nothing started, on
+    // LEDC, while running or stopping, for 0 pulses or while LD is asserted.
+    bool moveSteps(uint32_t pulses)
+    {
+        if (backend != PULSE_RMT || running || stopping || pulses == 0 ||
+            (prof.hasLD && ldAsserted()))
+            return false;
+
+        movePulses = pulses;
+        running    = true;
+        moveActive = true;
+        post(REQ_MOVE);
+        return true;
+    }
+
+    // Pulses still to be emitted by the current move (0 when idle).
+    uint32_t moveRemaining() const { return rmt.moveRemaining(); }
+
+    // Exact count of CLOCK pulses emitted by the RMT engine since boot.
+    uint64_t emittedPulses() const { return rmt.emittedPulses(); }
+
+    PulseBackend clockBackend() const { return backend; }
+
+    // Largest deviation of a motion tick from MOTION_TICK_US seen since the
+    // last reset, in us. This is how the fixed tick rate is verified.
+    uint32_t tickJitterUs() const { return tickJitterMaxUs; }
+    void resetTickJitter() { tickJitterMaxUs = 0; }
+
     // Coarse speed increase with tiered step sizes for fast navigation:
     //  0   ->  100 Hz
     // <1k -> +100 Hz
     // <5k -> +500 Hz
     // else -> +1000 Hz
-    // Clamped to profile max, and applied immediately if running.
+    // Clamped to profile max (and LEDC capability), and applied immediately if running.
     void stepSpeedUp()
     {
         uint32_t oldTarget = targetHz;
+        uint32_t hz = oldTarget;
+
+        uint32_t limit = clockLimitHz();
 
-        if (targetHz < prof.maxClockHz)
+        if (hz < limit)
         {
-            if (targetHz == 0)
+            if (hz == 0)
             {
-                targetHz = 100;
+                hz = 100;
             }
-            else if (targetHz < 1000)
+            else if (hz < 1000)
             {
-                targetHz += 100;
+                hz += 100;
             }
-            else if (targetHz < 5000)
+            else if (hz < 5000)
             {
-                targetHz += 500;
+                hz += 500;
             }
             else
             {
-                targetHz += 1000;
+                hz += 1000;
             }
         }
 
-        if (targetHz > prof.maxClockHz)
-            targetHz = prof.maxClockHz;
+        if (hz > limit)
+            hz = limit;
+
+        // Step over a resonance band rather than into it.
+        hz = skipTarget(hz, 1);
+        if (hz > limit)
+            hz = skipTarget(limit, -1);
+
+        // Publish once, so the motion tick never sees an intermediate value.
+        targetHz = hz;
 
 #if DEBUG_SPEED
-        Serial.print("Speed UP: ");
-        Serial.print(oldTarget);
-        Serial.print(" -> ");
-        Serial.print(targetHz);
-        Serial.print(" Hz (running: ");
-        Serial.print(running ? "YES" : "NO");
-        Serial.println(")");
+        // Not between binary telemetry frames: it would break one.
+        if (teleMode != TELE_BINARY)
+        {
+            Serial.print("Speed UP: ");
+            Serial.print(oldTarget);
+            Serial.print(" -> ");
+            Serial.print(hz);
+            Serial.print(" Hz (running: ");
+            Serial.print(running ? "YES" : "NO");
+            Serial.println(")");
+        }
 #endif
 
         if (running)
         {
             // Re-arm ramp toward new target (smooth speed change)
-            rampActive   = true;
-            lastRampTick = millis();
+            post(REQ_RETARGET);
         }
     }
 
@@ -231,82 +472,77 @@ public:
     void stepSpeedDown()
     {
         uint32_t oldTarget = targetHz;
+        uint32_t hz = oldTarget;
 
-        if (targetHz > 5000)
+        if (hz > 5000)
         {
-            targetHz -= 1000;
+            hz -= 1000;
         }
-        else if (targetHz > 1000)
+        else if (hz > 1000)
         {
-            targetHz -= 500;
+            hz -= 500;
         }
-        else if (targetHz > 100)
+        else if (hz > 100)
         {
-            targetHz -= 100;
+            hz -= 100;
         }
-        else if (targetHz > 0)
+        else if (hz > 0)
         {
-            targetHz = 0;
+            hz = 0;
         }
 
+        hz = skipTarget(hz, -1);
+        targetHz = hz;
+
 #if DEBUG_SPEED
-        Serial.print("Speed DOWN: ");
-        Serial.print(oldTarget);
-        Serial.print(" -> ");
-        Serial.print(targetHz);
-        Serial.print(" Hz (running: ");
-        Serial.print(running ? "YES" : "NO");
-        Serial.println(")");
+        if (teleMode != TELE_BINARY)
+        {
+            Serial.print("Speed DOWN: ");
+            Serial.print(oldTarget);
+            Serial.print(" -> ");
+            Serial.print(hz);
+            Serial.print(" Hz (running: ");
+            Serial.print(running ? "YES" : "NO");
+            Serial.println(")");
+        }
 #endif
 
         if (running)
         {
             // Re-arm ramp toward new (lower) target
-            rampActive   = true;
-            lastRampTick = millis();
+            post(REQ_RETARGET);
         }
     }
 
+    // Change the target frequency; while running the ramp takes it there.
+    // A target inside a skip band moves to its edge in the direction of
+    // the change.
+    void setTargetHz(uint32_t hz)
+    {
+        uint32_t old = targetHz;
+        targetHz = skipTarget(hz, hz > old ? 1 : hz < old ? -1 : 0);
+        if (running)
+            post(REQ_RETARGET);
+    }
+
     // Set absolute direction (CW = true, CCW = false) and push to hardware.
-    // If the motor is running, the clock is cut to 0 first, the direction pin is
-    // changed, and the ramp restarts from zero so the motor accelerates cleanly
-    // in the new direction instead of jumping mid-speed.
+    // If the motor is running, the motion tick ramps it down to REVERSAL_HZ,
+    // pauses the clock for the DIR hold/setup margins, flips the pin and
+    // ramps back up to targetHz (see stepReversal()). During a ramped stop
+    // or a move the pin changes once the clock has reached 0.
     void setDirCW(bool cw)
     {
         dirCW = cw;
-
-        if (running)
-        {
-            // Cut output immediately before flipping direction
-            setClock(0);
-            applyOutputs();
-
-            // Restart ramp from zero toward current targetHz
-            rampCurrentHz = 0;
-            rampActive    = true;
-            lastRampTick  = millis();
-
-            // Re-arm start timeout if profile has FG
-            if (prof.hasFG)
-            {
-                startTimeoutActive = true;
-                startTimeoutStart  = millis();
-                startTimeoutFired  = false;
-            }
-        }
-        else
-        {
-            applyOutputs();
-        }
+        post(running ? REQ_REVERSE : REQ_OUTPUTS);
 
 #if DEBUG_MOTOR
         Serial.print("Direction set to ");
         Serial.print(cw ? "CW" : "CCW");
-        Serial.println(running ? " (ramp restarted)" : "");
+        Serial.println(running ? " (reversing)" : "");
 #endif
     }
 
-    // Toggle direction — delegates to setDirCW so ramp-restart logic applies.
+    // Toggle direction — delegates to setDirCW so the reversal logic applies.
     void toggleDir()
     {
         setDirCW(!dirCW);
@@ -349,80 +585,533 @@ public:
         return alarm;
     }
 
+    // ---------------------- LD fault interrupt ----------------
+    // With LD in the profile, the asserting LD edge interrupts and the ISR
+    // cuts the motor itself: CLOCK is forced low through the GPIO matrix
+    // (ClockGate) and STOP is asserted within microseconds, then the
+    // motion tick carries out a regular emergency stop. The trip stays
+    // latched (CLOCK gated, record kept) until the next start.
+    bool ldTripped() const { return ldTrip; }
+    LdFault ldFault() const
+    {
+        // Sequence lock: isrLD() makes ldSeq odd while it writes the fields
+        // (it may run on the other core, from releaseLdTrip() in the tick).
+        // Read until the sequence is even and the same on both sides.
+        LdFault f;
+        uint32_t s;
+        do
+        {
+            s = ldSeq.load(std::memory_order_acquire);
+            uint32_t lo = ldAtUsLo.load(std::memory_order_relaxed);
+            uint32_t hi = ldAtUsHi.load(std::memory_order_relaxed);
+            f.atUs   = (int64_t)(((uint64_t)hi << 32) | lo);
+            f.hz     = ldHz.load(std::memory_order_relaxed);
+            f.rpmX10 = ldRpmX10.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((s & 1) || ldSeq.load(std::memory_order_relaxed) != s);
+        f.count = s / 2;
+        return f;
+    }
+
     // Periodically compute RPM from FG pulses:
-    //  - Every RPM_SAMPLE_MS, atomically read and clear pulse counter.
-    //  - RPM = (pulses * 60) / PPR, if FG present and PPR > 0.
-    //  - Safety: If FG present and motor is running but RPM=0 while clock>0,
-    //            reduce target to 1/4 currentHz to mitigate a stall/missed feedback.
-    //  - Optional telemetry dump to Serial if enabled.
+    //  - Adaptive window: an estimate is taken once at least RPM_MIN_PULSES
+    //    (or PPR, if larger) FG edges and RPM_MIN_WINDOW_MS have gone by, or
+    //    after RPM_SAMPLE_MS (AUTOTUNE_SAMPLE_MS while autotuning) at the
+    //    latest. At speed that is every 50 ms; near standstill up to 1 s.
+    //  - rpmX10 (tenths) from the edge count or the edge period, whichever
+    //    suits the pulse rate (see measureRpm()), passed through the
+    //    profile's filter chain (RpmFilter); rpm is rpmX10 rounded.
+    //    rpmReading() adds the timestamp and confidence of the estimate.
+    //  - Slip: the raw estimate is compared with the speed the clock should
+    //    give (SlipMonitor); the window is capped at SLIP_WINDOW_MS meanwhile.
+    //    Warn, derate or stop on the tier reached (see onSlipLevel()).
+    //  - FG watchdog: each steady reading publishes the clock-to-RPM ratio
+    //    that checkFgWatchdog() uses, in the motion tick, to cut the motor
+    //    as soon as FG edges stop rather than a window later.
+    //  - Jitter: in period mode each window also yields the mean and
+    //    variance of the edge intervals (PeriodStats, in drainFgEdges());
+    //    steady windows add to fgJitter().
+    //  - FG loss: a definite raw 0 RPM while running with a nonzero clock
+    //    opens the loop and stops any autotune, calibration or sweep
+    //    (dropFeedbackUse()), then jumps the clock to 1/4 of currentHz.
+    //  - Optional telemetry dump to Serial (every RPM_SAMPLE_MS) if enabled.
+    //    Binary records are sent on every call, whatever the window.
     void sampleRPM()
     {
+        if (teleMode == TELE_BINARY)
+            flushTelemetry();
+
         uint32_t now = millis();
-        if (now - lastRpmSample >= RPM_SAMPLE_MS)
+        uint32_t elapsed = now - lastRpmSample;
+        if (elapsed < RPM_MIN_WINDOW_MS)
+            return;
+
+        // Close the window early once it holds enough edges.
+        uint32_t minPulses = prof.ppr > RPM_MIN_PULSES ? prof.ppr : RPM_MIN_PULSES;
+        uint32_t windowMs = rpmWindowMs;
+        if (slip.armed() && running && windowMs > SLIP_WINDOW_MS)
+            windowMs = SLIP_WINDOW_MS;
+        if (elapsed >= windowMs || peekFgPulses() >= minPulses)
         {
-            // Atomically snapshot and reset the pulse count.
-            noInterrupts();
-            uint32_t p = fgPulses;
-            fgPulses = 0;
-            interrupts();
+            uint32_t p = takeFgPulses();
+
+            uint32_t dtMs = elapsed;
+            lastRpmSample = now;
 
             if (prof.hasFG && prof.ppr > 0)
-                rpm = (p * 60UL) / prof.ppr;
+                reading = measureRpm(p, dtMs, minPulses);
             else
-                rpm = 0;
+                reading = {0, 0, 0};
+            reading.atMs = now;
+            rawRpmX10 = reading.rpmX10;
+            reading.rpmX10 = rpmFilter.update(rawRpmX10);
+            rpmX10 = reading.rpmX10;
+            rpm = (rpmX10 + 5) / 10;
+
+            // Slip check against the mean clock over the window. Each start
+            // rearms it (grace time, tier cleared).
+            uint32_t hzNow = currentHz;
+            uint32_t hzAvg = (slipHzStart + hzNow) / 2;
+            slipHzStart = hzNow;
+            if (running && !slipRun)
+            {
+                slip.rearm(now);
+                slipStallFired = false;
+            }
+            slipRun = running;
+
+            // Interval jitter of a steady window (a ramping clock would
+            // show up as jitter).
+            if (fgPeriodMode && running && !rampActive && !moveActive && revPhase == REV_NONE &&
+                !edgeWin.dropped)
+                jitterRun.add(edgeWin.period);
+            if (prof.hasFG && prof.ppr > 0 && running && !moveActive && revPhase == REV_NONE &&
+                !calibrating && !sweeping)
+            {
+                // Ratio for the FG watchdog: the slip one, or else the last
+                // steady, full-confidence reading.
+                if (slip.armed())
+                    fgWdRatioQ16 = slip.ratioQ16();
+                else if (!rampActive && reading.confidence == 100 && rawRpmX10 > 0 && hzAvg > 0)
+                    fgWdRatioQ16 = (uint32_t)(((uint64_t)rawRpmX10 << 16) / hzAvg);
+
+                SlipLevel prev = slip.level();
+                SlipLevel lvl  = slip.update(hzAvg, rawRpmX10, dtMs, now, !rampActive,
+                                             reading.confidence == 100);
+                if (lvl > prev)
+                    onSlipLevel(lvl);
+            }
 
-            lastRpmSample = now;
+#if SKIP_LIVE_DETECT
+            // Live resonance check: a wide FG period spread at a steady clock.
+            if (fgPeriodMode && running && !rampActive && !moveActive && revPhase == REV_NONE &&
+                !autotuning && !calibrating && !sweeping)
+            {
+                if (resWatch.update(hzNow, fgPeriodSpreadPct(), dtMs, true))
+                    addLiveSkipBand(resWatch.hz());
+            }
+            else
+            {
+                resWatch.reset();
+            }
+#endif
 
-            // FG loss safety: detected when no pulses despite nonzero clock and running state.
+            // FG loss safety: detected when no pulses despite nonzero clock and running state
+            // (a definite 0, not a low-confidence upper bound that rounds to 0). It looks
+            // at the raw estimate, so the filter cannot delay it.
+            // Without feedback the speed loop cannot work, so it drops back to open loop.
             if (prof.hasFG && running)
             {
-                if (rpm == 0 && currentHz > 0)
+                if (rawRpmX10 == 0 && reading.confidence == 100 && currentHz > 0)
                 {
+                    dropFeedbackUse();
                     targetHz = currentHz / 4;
-                    setClock(targetHz);
+                    post(REQ_JUMP);
 #if DEBUG_MOTOR
                     Serial.println("FG loss detected - reducing speed");
 #endif
                 }
             }
 
+            if (autotuning)
+                serviceAutotune(now);
+            if (calibrating)
+                serviceCalibration(p, dtMs, hzAvg, now);
+            if (sweeping)
+                serviceSweep(dtMs, hzAvg, now);
+
+            // Closed-loop speed: trim the commanded frequency from the RPM
+            // error. The ramp still limits how fast the clock follows.
+            if (closedLoop && running && revPhase == REV_NONE)
+            {
+                uint32_t lo = prof.startHz < hwMinHz() ? hwMinHz() : prof.startHz;
+                int32_t err = (int32_t)targetRpm - (int32_t)rpm;
+                targetHz = speedPi.update(err, dtMs, lo, clockLimitHz());
+                post(REQ_RETARGET);
+            }
+
             // Optional telemetry (RPM, clock, target, direction, LD status).
-            if (telemetryOn)
+            if (teleMode == TELE_TEXT && now - lastTelemetryMs >= RPM_SAMPLE_MS)
             {
+                lastTelemetryMs = now;
                 Serial.print("RPM:");
-                Serial.print(rpm);
+                Serial.print(rpmX10 / 10);
+                Serial.print(".");
+                Serial.print(rpmX10 % 10);
+                Serial.print(fgPeriodMode ? "(P)" : "(C)");
+                Serial.print(" Q:");
+                Serial.print(reading.confidence);
+                if (rpmFilter.active())
+                {
+                    Serial.print(" Raw:");
+                    Serial.print(rawRpmX10 / 10);
+                    Serial.print(".");
+                    Serial.print(rawRpmX10 % 10);
+                }
+                if (fgPeriodMode && edgeWin.period.count() > 0)
+                {
+                    Serial.print(" Edge(us):");
+                    Serial.print(edgeWin.period.minUs());
+                    Serial.print("-");
+                    Serial.print(edgeWin.period.maxUs());
+                    Serial.print(" Mean:");
+                    Serial.print(edgeWin.period.meanUs());
+                    Serial.print(" SD:");
+                    Serial.print(edgeWin.period.stdDevUs());
+                }
                 Serial.print(" Hz:");
-                Serial.print(currentHz);
+                Serial.print(currentHz.load());
                 Serial.print(" Target:");
-                Serial.print(targetHz);
+                Serial.print(targetHz.load());
+                if (slip.armed())
+                {
+                    Serial.print(" Slip:");
+                    Serial.print(slip.slipPct());
+                    Serial.print("%");
+                }
+                if (closedLoop)
+                {
+                    Serial.print(" SetRPM:");
+                    Serial.print(targetRpm);
+                }
+                Serial.print(" Err(mHz):");
+                Serial.print(clockErrorMilliHz());
+                if (clampCount > 0)
+                {
+                    Serial.print(" Clamp:");
+                    Serial.print(clampReasonName(clampReason));
+                    Serial.print("@");
+                    Serial.print(clampRequestedHz);
+                    Serial.print("x");
+                    Serial.print(clampCount.load());
+                }
+                Serial.print(" Jit(us):");
+                Serial.print(tickJitterUs());
+                Serial.print(" Stop(ms):");
+                Serial.print(stopTimeMs());
+                if (fgWdTrips > 0)
+                {
+                    Serial.print(" FGwd(us):");
+                    Serial.print(fgWdLatencyUs.load());
+                    Serial.print("/");
+                    Serial.print(fgWdDeadlineUs.load());
+                }
                 Serial.print(" DIR:");
                 Serial.print(dirCW ? "CW" : "CCW");
                 Serial.print(" LD:");
-                Serial.println(ldAlarm() ? "ALARM" : "OK");
+                Serial.print(ldAlarm() ? "ALARM" : "OK");
+                LdFault ld = ldFault();
+                if (ld.count > 0)
+                {
+                    Serial.print(" LDtrip:");
+                    Serial.print(ld.count);
+                    Serial.print("@");
+                    Serial.print((uint32_t)(ld.atUs / 1000));
+                    Serial.print("ms");
+                }
+                Serial.println();
             }
         }
     }
 
+    // ---------------------- Closed-loop speed ----------------
+    // With FG feedback the motor can regulate RPM instead of clock Hz: a
+    // SpeedPI (gains from the profile) turns the RPM error into targetHz at
+    // every RPM sample. Returns false if the profile has no usable FG.
+    bool setClosedLoop(bool on)
+    {
+        if (on && !(prof.hasFG && prof.ppr > 0))
+            return false;
+
+        // Engage bumplessly from the current clock, holding the current speed.
+        if (on && !closedLoop)
+        {
+            speedPi.reset(running ? (uint32_t)currentHz : (uint32_t)targetHz);
+            if (running)
+                targetRpm = rpm;
+        }
+        closedLoop = on;
+
+#if DEBUG_MOTOR
+        Serial.print("Closed loop ");
+        Serial.println(on ? "ON" : "OFF");
+#endif
+        return true;
+    }
+
+    bool isClosedLoop() const { return closedLoop; }
+
+    // True while RPM comes from the FG edge period rather than the count.
+    bool rpmByPeriod() const { return fgPeriodMode; }
+
+    // Latest RPM estimate with its timestamp and confidence.
+    RpmReading rpmReading() const { return reading; }
+
+    // Slip monitor state: tier, last slip %, ratio, trip latency.
+    const SlipMonitor &slipMonitor() const { return slip; }
+    SlipLevel slipLevel() const { return slip.level(); }
+
+    // FG edges of the last period-mode window (interval statistics, drops).
+    EdgeWindow fgEdgeWindow() const { return edgeWin; }
+
+    // Interval jitter of the steady period-mode windows since the last
+    // resetFgJitter() (e.g. over an auto test; see JitterSummary).
+    const JitterSummary &fgJitter() const { return jitterRun; }
+    void resetFgJitter() { jitterRun.reset(); }
+    uint32_t fgEdgeDropCount() const { return fgEdges.dropped(); }
+
+    // RPM setpoint used while the loop is closed.
+    void setTargetRpm(uint32_t r) { targetRpm = r; }
+    uint32_t getTargetRpm() const { return targetRpm; }
+
+    // UP/DOWN on HOME in closed loop: move the setpoint by RPM_STEP.
+    void stepRpmUp()   { targetRpm += RPM_STEP; }
+    void stepRpmDown() { targetRpm = (targetRpm > RPM_STEP) ? targetRpm - RPM_STEP : 0; }
+
+    // ---------------------- Speed-loop autotune ----------------
+    // Relay test around the current targetHz (see RelayAutotune), fed from
+    // sampleRPM() with a shorter RPM window. The motor must be running with
+    // FG; the loop is opened for the test. On success the gains are written
+    // into prof (the caller persists them) and the speed returns to the base
+    // frequency. Stopping the motor or losing FG aborts the test.
+    bool startAutotune()
+    {
+        if (!(prof.hasFG && prof.ppr > 0) || !running || moveActive || stopping || calibrating ||
+            sweeping)
+            return false;
+
+        uint32_t base  = targetHz;
+        uint32_t limit = clockLimitHz();
+        uint32_t d = base * AUTOTUNE_RELAY_PCT / 100;
+        if (base + d > limit)
+            d = (limit > base) ? limit - base : 0;
+        if (d == 0 || base <= d)
+            return false;
+
+        closedLoop  = false;
+        rpmWindowMs = AUTOTUNE_SAMPLE_MS;
+        tuner.begin(base, d, millis());
+        autotuning  = true;
+
+#if DEBUG_MOTOR
+        Serial.print("Autotune started at ");
+        Serial.print(base);
+        Serial.print(" +/- ");
+        Serial.print(d);
+        Serial.println(" Hz");
+#endif
+        return true;
+    }
+
+    void abortAutotune()
+    {
+        if (autotuning)
+        {
+            tuner.abort();
+            endAutotune();
+        }
+    }
+
+    bool isAutotuning() const { return autotuning; }
+
+    // Progress and result of the last test (state AT_DONE: gains applied).
+    const RelayAutotune &autotuner() const { return tuner; }
+
+    // ---------------------- FG calibration --------------------
+    // Steps the clock up to the current target (see FgCalibrator) and fits
+    // FG edges per clock pulse. On success the profile is updated: with
+    // clockPerRev set, ppr is derived from it; otherwise clockPerRev is
+    // derived from the entered ppr. The caller persists prof. The loop is
+    // opened and the slip check and FG watchdog rest meanwhile, since they
+    // rely on the very ratio being measured.
+    bool startCalibration()
+    {
+        if (!prof.hasFG || !running || moveActive || stopping || autotuning || sweeping)
+            return false;
+
+        uint32_t top = targetHz;
+        if (top > clockLimitHz())
+            top = clockLimitHz();
+        if (top < CAL_POINTS)
+            return false;
+
+        closedLoop   = false;
+        rpmWindowMs  = CAL_SAMPLE_MS;
+        fgWdRatioQ16 = 0;
+        calib.begin(top, millis());
+        calibrating  = true;
+        setTargetHz(calib.currentPointHz());
+
+#if DEBUG_MOTOR
+        Serial.print("FG calibration up to ");
+        Serial.print(top);
+        Serial.println(" Hz");
+#endif
+        return true;
+    }
+
+    void abortCalibration()
+    {
+        if (calibrating)
+        {
+            calib.abort();
+            endCalibration();
+        }
+    }
+
+    bool isCalibrating() const { return calibrating; }
+
+    // Progress and result of the last calibration.
+    const FgCalibrator &calibrator() const { return calib; }
+
+    // ---------------------- Frequency sweep -------------------
+    // Steps the clock from the profile start frequency to the clock limit
+    // (see FreqSweep), linearly or logarithmically, and records the settled
+    // RPM and ripple of each step. The loop is opened and the slip check and
+    // FG watchdog rest, so the sweep can run into pull-out; it ends there
+    // (or on FG loss) and the motor is stopped. The caller persists
+    // sweeper().curve() (ProfileStore::saveCurve()).
+    bool startSweep(bool logSpacing)
+    {
+        if (!(prof.hasFG && prof.ppr > 0) || !running || moveActive || stopping ||
+            autotuning || calibrating)
+            return false;
+
+        uint32_t lo = prof.startHz < hwMinHz() ? hwMinHz() : prof.startHz;
+        uint32_t hi = clockLimitHz();
+        if (hi <= lo)
+            return false;
+
+        closedLoop   = false;
+        rpmWindowMs  = SWEEP_SAMPLE_MS;
+        fgWdRatioQ16 = 0;
+        sweep.begin(lo, hi, logSpacing, slip.armed() ? slip.ratioQ16() : 0, millis());
+        sweeping     = true;
+        setTargetHz(sweep.currentStepHz());
+
+#if DEBUG_MOTOR
+        Serial.print("Sweep ");
+        Serial.print(lo);
+        Serial.print(" -> ");
+        Serial.print(hi);
+        Serial.println(logSpacing ? " Hz (log)" : " Hz (linear)");
+#endif
+        return true;
+    }
+
+    void abortSweep()
+    {
+        if (sweeping)
+        {
+            sweep.abort();
+            endSweep();
+        }
+    }
+
+    bool isSweeping() const { return sweeping; }
+
+    // Progress and result of the last sweep.
+    const FreqSweep &sweeper() const { return sweep; }
+
+    // ------------------------ Skip bands ----------------------
+    // Resonance bands of the profile (see SkipBands.h). A finished sweep
+    // replaces them with the bands found in its curve; the live check adds
+    // to them. takeSkipBandsChanged() tells the caller to persist prof.
+    const SkipBand *skipBands() const { return prof.skip; }
+
+    bool takeSkipBandsChanged() { return skipBandsChanged.exchange(false); }
+
+    // Print a curve over serial as CSV (hz,rpm,ripple), after '#' header
+    // lines (the second lists the profile's skip bands).
+    void dumpCurve(const SweepCurve &c) const
+    {
+        Serial.print("# Sweep ");
+        Serial.print(prof.name);
+        Serial.print(c.logSpacing ? " log, " : " linear, ");
+        Serial.print(c.count);
+        Serial.print(" points, pull-out ");
+        if (c.pullOut < c.count)
+        {
+            Serial.print(c.pt[c.pullOut].hz);
+            Serial.println(" Hz");
+        }
+        else
+        {
+            Serial.println("none");
+        }
+        Serial.print("# Skip bands:");
+        for (uint8_t i = 0; i < SKIP_MAX_BANDS; i++)
+        {
+            if (!skipBandUsed(prof.skip[i]))
+                continue;
+            Serial.print(' ');
+            Serial.print(prof.skip[i].loHz);
+            Serial.print('-');
+            Serial.print(prof.skip[i].hiHz);
+        }
+        Serial.println(skipBandCount(prof.skip) ? " Hz" : " none");
+        Serial.println("hz,rpm,ripple_rpm");
+        for (uint8_t i = 0; i < c.count; i++)
+        {
+            Serial.print(c.pt[i].hz);
+            Serial.print(',');
+            Serial.print(c.pt[i].rpm);
+            Serial.print(',');
+            Serial.print(c.pt[i].rippleX10 / 10);
+            Serial.print('.');
+            Serial.println(c.pt[i].rippleX10 % 10);
+        }
+    }
+
     // ---------------------- FG ISR ----------------------
-    // Increment pulse count on each rising edge for RPM calculation.
+    // Timestamps rising edges for period measurement (low FG rates), and is
+    // the edge counter too when PCNT is unavailable.
     static void IRAM_ATTR isrFG();
 
+    // LD asserting edge: see ldTripped(). 'arg' is the MotorRuntime.
+    static void IRAM_ATTR isrLD(void *arg);
+
     // ---------------------- System settings --------------
-    // Enable/disable telemetry and persist to NVS.
-    void setTelemetry(bool on)
+    // Set the telemetry mode (off / text / binary) and persist to NVS.
+    void setTelemetryMode(TelemetryMode m)
     {
-        telemetryOn = on;
-        sysPrefs.begin("sys", false);
-        sysPrefs.putBool("tele", telemetryOn);
-        sysPrefs.end();
-
 #if DEBUG_MOTOR
         Serial.print("Telemetry set to ");
-        Serial.println(on ? "ON" : "OFF");
+        Serial.println(m == TELE_TEXT ? "TEXT" : m == TELE_BINARY ? "BINARY" : "OFF");
 #endif
+        // Records left from an earlier binary stint would be stale.
+        teleRing.clear();
+        teleSync = true;
+        teleMode = m;
+        sysPrefs.begin("sys", false);
+        sysPrefs.putUChar("telm", m);
+        sysPrefs.end();
     }
 
-    bool telemetry() const { return telemetryOn; }
+    TelemetryMode telemetryMode() const { return (TelemetryMode)teleMode.load(); }
+
+    // Binary records dropped because loop() could not send them in time.
+    uint32_t telemetryDropCount() const { return teleRing.dropped(); }
 
     // Set UI language and persist to NVS.
     void setLanguage(Language L)
@@ -443,59 +1132,292 @@ public:
     // ---------------------- Public fields ----------------
     // Expose current profile and key runtime state for UI/control modules.
     MotorProfile prof;
-    bool        dirCW = true, brakeOn = false, enabled = true, running = false;
-    uint32_t    targetHz = 1000, currentHz = 0, rpm = 0;
+    bool        brakeOn = false, enabled = true;
+
+    // Shared with the motion tick. 'running' is the requested state and is
+    // set by loop() right away; the tick clears it when it stops by itself.
+    // 'dirCW' is the requested direction (see dirApplied for the pin).
+    std::atomic<bool>     running{false}, dirCW{true};
+    std::atomic<uint32_t> targetHz{1000}, currentHz{0}, rpm{0};
+    std::atomic<uint32_t> rpmX10{0};   // Measured speed in tenths of RPM
+
+    // ---- Clock clamp record ----
+    // Last setpoint that could not be generated as requested, and why.
+    enum ClampReason : uint8_t { CLAMP_NONE, CLAMP_PROFILE, CLAMP_HW_MAX, CLAMP_HW_MIN };
+    ClampReason clampReason      = CLAMP_NONE;
+    uint32_t    clampRequestedHz = 0;
+    std::atomic<uint32_t> clampCount{0};
+
+    static const char *clampReasonName(ClampReason r)
+    {
+        switch (r)
+        {
+        case CLAMP_PROFILE: return "PROF";
+        case CLAMP_HW_MAX:  return "HWMAX";
+        case CLAMP_HW_MIN:  return "HWMIN";
+        default:            return "-";
+        }
+    }
 
-    // ---- Ramp state ----
-    bool     rampActive = false;   // true while ramping toward targetHz
-    uint32_t rampCurrentHz = 0;    // current ramp position
+    // ---- Positioned move state ----
+    std::atomic<bool> moveActive{false};  // true while an RMT N-pulse move is running
 
-    // ---- Start timeout state ----
+    // ---- Ramp state (owned by the motion tick) ----
+    std::atomic<bool> rampActive{false};  // true while ramping toward targetHz (read by loop())
+
+    // ---- Start timeout state (owned by the motion tick) ----
     bool     startTimeoutActive = false;
     uint32_t startTimeoutStart  = 0;
 
-    // Update the ramp tick and start-timeout check.
-    // Must be called frequently from the main loop (ideally every ~10 ms).
-    void updateRamp()
+    // Public flag: UI can read this to show a "no RPM / stall" warning.
+    std::atomic<bool> startTimeoutFired{false};
+
+    // Set when the slip check stopped the motor (cleared by the next start).
+    std::atomic<bool> slipStallFired{false};
+
+    // Set when the FG watchdog cut the motor (cleared by the next start).
+    std::atomic<bool> fgLossFired{false};
+
+    // Last FG watchdog trip: time from the last FG edge to the cut, the
+    // deadline that was in force, and the trip count since boot.
+    uint32_t fgWatchdogLatencyUs() const { return fgWdLatencyUs; }
+    uint32_t fgWatchdogDeadlineUs() const { return fgWdDeadlineUs; }
+    uint32_t fgWatchdogTrips() const { return fgWdTrips; }
+
+private:
+    // ---------------------- Motion tick ----------------------
+    // loop() never touches the clock, the ramp or the RMT engine directly:
+    // it updates the shared atomics above and posts REQ_* bits, which the
+    // tick consumes at its next period. No locks are taken on either side.
+    enum : uint32_t
     {
-        uint32_t now = millis();
+        REQ_HALT     = 1u << 0,   // Cut the clock (or abort a move)
+        REQ_START    = 1u << 1,   // (Re)start the ramp from prof.startHz
+        REQ_MOVE     = 1u << 2,   // Launch an N-pulse move (movePulses)
+        REQ_RETARGET = 1u << 3,   // Ramp toward a new targetHz
+        REQ_JUMP     = 1u << 4,   // Set targetHz immediately (FG guard)
+        REQ_DECEL    = 1u << 5,   // Ramped stop (stop modes STOP_RAMP*)
+        REQ_ESTOP    = 1u << 6,   // Emergency stop
+        REQ_OUTPUTS  = 1u << 7,   // Latch dirCW and refresh outputs when idle
+        REQ_REVERSE  = 1u << 8,   // Reverse a running motor (stepReversal)
+    };
+
+    // Reversal sequence phases.
+    enum RevPhase : uint8_t
+    {
+        REV_NONE,    // No reversal in progress
+        REV_DECEL,   // Ramping down to REVERSAL_HZ
+        REV_HOLD,    // Clock paused: last edge out, DIR hold time running
+        REV_SETUP    // DIR flipped: setup time before the clock resumes
+    };
 
-        // ---- Ramp tick ----
-        if (rampActive && running)
+    void post(uint32_t req) { pendingReq.fetch_or(req); }
+
+    static void onTick(void *arg) { ((MotorRuntime *)arg)->tick(); }
+
+    void tick()
+    {
+        // Jitter: how far this tick landed from its nominal period.
+        int64_t nowUs = esp_timer_get_time();
+        if (lastTickUs != 0)
         {
-            if (now - lastRampTick >= RAMP_INTERVAL_MS)
-            {
-                lastRampTick = now;
+            int64_t dev = nowUs - lastTickUs - MOTION_TICK_US;
+            if (dev < 0) dev = -dev;
+            if ((uint64_t)dev > tickJitterMaxUs)
+                tickJitterMaxUs = (uint32_t)dev;
+        }
+        lastTickUs = nowUs;
 
-                if (rampCurrentHz < targetHz)
-                {
-                    rampCurrentHz += RAMP_STEP_HZ;
-                    if (rampCurrentHz > targetHz)
-                        rampCurrentHz = targetHz;
-                    setClock(rampCurrentHz);
-                }
-                else if (rampCurrentHz > targetHz)
-                {
-                    // Deceleration ramp
-                    if (rampCurrentHz > RAMP_STEP_HZ)
-                        rampCurrentHz -= RAMP_STEP_HZ;
-                    else
-                        rampCurrentHz = 0;
-                    if (rampCurrentHz < targetHz)
-                        rampCurrentHz = targetHz;
-                    setClock(rampCurrentHz);
-                }
-                else
+        // loop() is reconfiguring the motor; stay out of its way.
+        if (parkReq)
+        {
+            parked = true;
+            return;
+        }
+
+        uint32_t req = pendingReq.exchange(0);
+        if (req & REQ_ESTOP)
+            estop();
+        if (req & REQ_HALT)
+            halt();
+        if ((req & REQ_DECEL) && !running)
+            beginDecel();
+        if ((req & REQ_OUTPUTS) && !stopping && !moveActive)
+        {
+            dirApplied = dirCW.load();
+            applyOutputs();
+        }
+        if ((req & REQ_START) && running)
+            resumeOrStart();
+        if ((req & REQ_REVERSE) && running && !stopping && !moveActive &&
+            revPhase == REV_NONE && dirCW != dirApplied)
+        {
+            // Already at or below the reversal speed: pause right here.
+            revPhase = REV_DECEL;
+            if (currentHz > REVERSAL_HZ)
+                armRamp();
+            else
+                rampActive = false;
+        }
+        if (req & REQ_MOVE)
+            beginMove();
+        if ((req & REQ_RETARGET) && running)
+            armRamp();
+        if ((req & REQ_JUMP) && running && revPhase < REV_HOLD)
+        {
+            setClock(targetHz);
+            ramp.reset(currentHz);
+        }
+
+        updateRamp();
+
+        // Binary telemetry: one record every TELEM_TICKS ticks.
+        if (teleMode == TELE_BINARY && ++teleTicks >= TELEM_TICKS)
+        {
+            teleTicks = 0;
+            captureTelemetry(nowUs);
+        }
+    }
+
+    static constexpr uint32_t TELEM_TICKS = (1000000 / MOTION_TICK_US) / TELEM_RATE_HZ;
+    static_assert(TELEM_TICKS >= 1, "TELEM_RATE_HZ above the motion tick rate");
+
+    // Tick side of the binary telemetry: snapshot the state into the ring.
+    // A full ring drops the record; the next one that fits carries TF_GAP.
+    void captureTelemetry(int64_t nowUs)
+    {
+        TelemetryRecord r;
+        r.version   = TELEM_VERSION;
+        r.size      = sizeof(TelemetryRecord);
+        r.seq       = teleSeq++;
+        r.timeUs    = (uint32_t)nowUs;
+        r.currentHz = currentHz;
+        r.targetHz  = targetHz;
+        r.rpmX10    = rpmX10;
+
+        uint16_t f = 0;
+        if (running)                                      f |= TF_RUNNING;
+        if (stopping)                                     f |= TF_STOPPING;
+        if (dirApplied)                                   f |= TF_DIR_CW;
+        if (rampActive)                                   f |= TF_RAMPING;
+        if (closedLoop)                                   f |= TF_CLOSED;
+        if (prof.hasLD && ldAsserted())                   f |= TF_LD;
+        if (ldTrip)                                       f |= TF_LD_TRIP;
+        if (fgPeriodMode)                                 f |= TF_PERIOD;
+        f |= (uint16_t)slip.level() << TF_SLIP_SHIFT;
+        if (fgLossFired)                                  f |= TF_FG_LOSS;
+        if (startTimeoutFired || slipStallFired)          f |= TF_STALL;
+        if (moveActive)                                   f |= TF_MOVE;
+        if (autotuning || calibrating || sweeping)        f |= TF_TEST;
+        if (teleGap)                                      f |= TF_GAP;
+        r.flags = f;
+
+        teleGap = !teleRing.push(r);
+    }
+
+    // loop() side: frame and send the queued records while the serial
+    // buffer has room for a whole frame, so loop() never blocks on it.
+    // A lone delimiter first ends whatever text went out before.
+    void flushTelemetry()
+    {
+        if (teleSync && Serial.availableForWrite() > 0)
+        {
+            Serial.write((uint8_t)0);
+            teleSync = false;
+        }
+        TelemetryRecord r;
+        uint8_t frame[TELEM_FRAME_MAX];
+        while (Serial.availableForWrite() >= (int)TELEM_FRAME_MAX && teleRing.pop(r))
+            Serial.write(frame, telemEncodeFrame(r, frame));
+    }
+
+    // Advance the RMT engine, the ramp, the start-timeout check and the FG
+    // watchdog by one tick.
+    void updateRamp()
+    {
+        uint32_t now = millis();
+
+        // ---- RMT pulse engine ----
+        // Keep the streamed buffers full and track a running move to its end.
+        if (backend == PULSE_RMT)
+        {
+            rmt.service();
+            if (moveActive)
+            {
+                currentHz = rmt.frequency();
+                if (!rmt.moving())
                 {
-                    // Reached target
-                    rampActive = false;
+                    moveActive = false;
+                    running    = false;
+                    currentHz  = 0;
+                    dirApplied = dirCW.load();
+                    applyOutputs();
 #if DEBUG_MOTOR
-                    Serial.println("Ramp complete");
+                    Serial.println("Move complete");
 #endif
                 }
             }
         }
 
+        // ---- Direction reversal ----
+        if (revPhase != REV_NONE && running)
+            stepReversal();
+
+        // ---- Ramp step ----
+        // The planner integrates over the real time since its last step, so
+        // a late tick advances it further instead of stretching the ramp.
+        // Gaps beyond RAMP_MAX_DT_US (e.g. a parked tick) are not caught up.
+        if (rampActive && (running || stopping) && revPhase < REV_HOLD)
+        {
+            int64_t elapsed = lastTickUs - rampLastUs;
+            uint32_t dtUs = (elapsed > RAMP_MAX_DT_US) ? RAMP_MAX_DT_US
+                          : (elapsed > 0 ? (uint32_t)elapsed : 0);
+            rampLastUs = lastTickUs;
+
+            uint32_t target = stopping ? 0 : (uint32_t)targetHz;
+            if (revPhase == REV_DECEL && target > REVERSAL_HZ)
+                target = REVERSAL_HZ;
+            uint32_t hz = ramp.step(target, dtUs);
+
+            // Inside a skip band on the way to a target outside it: go to
+            // the far edge at once, keeping the acceleration.
+            uint32_t out = skipBandExit(prof.skip, hz, target);
+            if (out != hz)
+            {
+                hz = out;
+                ramp.jump(hz);
+            }
+
+            // Below the start frequency a zero target is reached by
+            // cutting the clock, mirroring the jump used when starting.
+            if (target == 0 && hz <= prof.startHz)
+            {
+                hz = 0;
+                ramp.reset(0);
+            }
+
+            if (hz != currentHz)
+                setClock(hz);
+
+            if (stopping && hz == 0)
+            {
+                finishStop(prof.stopMode == STOP_RAMP_BRAKE);
+#if DEBUG_MOTOR
+                Serial.print("Ramped stop done in ");
+                Serial.print(lastStopMs.load());
+                Serial.println(" ms");
+#endif
+            }
+            else if (ramp.settled(target))
+            {
+                // Reached target
+                rampActive = false;
+#if DEBUG_MOTOR
+                Serial.println("Ramp complete");
+#endif
+            }
+        }
+
         // ---- Start timeout check ----
         if (startTimeoutActive && running)
         {
@@ -504,7 +1426,8 @@ public:
                 // Only trigger if FG is configured and we still have no RPM
                 if (prof.hasFG && rpm == 0)
                 {
-                    stop();
+                    running = false;
+                    halt();
                     startTimeoutActive = false;
                     startTimeoutFired  = true;
 #if DEBUG_MOTOR
@@ -525,27 +1448,913 @@ public:
                 startTimeoutFired  = false;
             }
         }
+
+        // ---- FG edge watchdog ----
+        checkFgWatchdog();
     }
 
-    // Public flag: UI can read this to show a "no RPM / stall" warning.
-    bool startTimeoutFired = false;
+    // Cut the motor as soon as FG edges stop, instead of waiting for an RPM
+    // window to come back empty. Armed once the start timeout has seen RPM,
+    // while the clock runs steadily forward (no reversal or move) and the
+    // clock-to-RPM ratio is known. The deadline is FG_WD_PERIODS expected
+    // FG periods at currentHz, recomputed every tick, so it follows the ramp.
+    void checkFgWatchdog()
+    {
+        uint32_t ratio = fgWdRatioQ16;
+        uint32_t hz    = currentHz;
+        if (!(running && prof.hasFG && prof.ppr > 0) || startTimeoutActive || moveActive ||
+            revPhase != REV_NONE || ratio == 0 || hz == 0)
+        {
+            fgWdLastEdgeUs = lastTickUs;
+            fgWdLastCount  = fgEdgeCount();
+            return;
+        }
 
-private:
-    // Pulse counter updated from ISR; must be volatile.
-    static volatile uint32_t fgPulses;
+        uint32_t c = fgEdgeCount();
+        if (c != fgWdLastCount)
+        {
+            fgWdLastCount  = c;
+            fgWdLastEdgeUs = lastTickUs;
+            return;
+        }
+
+        // FG edges/s = rpmX10 * ppr / 600, rpmX10 = hz * ratio / 2^16.
+        uint64_t rate = (uint64_t)hz * ratio * prof.ppr;
+        uint64_t periodUs = (600000000ULL << 16) / rate;
+        uint64_t limitUs = periodUs * FG_WD_PERIODS;
+        if (limitUs < FG_WD_MIN_MS * 1000ULL) limitUs = FG_WD_MIN_MS * 1000ULL;
+        if (limitUs > FG_WD_MAX_MS * 1000ULL) limitUs = FG_WD_MAX_MS * 1000ULL;
+
+        int64_t silentUs = lastTickUs - fgWdLastEdgeUs;
+        if (silentUs < (int64_t)limitUs)
+            return;
+
+        fgWdLatencyUs  = (uint32_t)silentUs;
+        fgWdDeadlineUs = (uint32_t)limitUs;
+        fgWdTrips++;
+        running = false;
+        halt();
+        fgLossFired = true;
+#if DEBUG_MOTOR
+        Serial.print("FG watchdog: no edge for ");
+        Serial.print(fgWdLatencyUs.load());
+        Serial.println(" us, motor cut");
+#endif
+    }
+
+    // Edge total as seen from the tick: PCNT hardware count, or the ISR one.
+    uint32_t fgEdgeCount() const
+    {
+        return fgHw ? (uint32_t)fgCounter.raw() : fgPulses;
+    }
+
+    // One tick of the reversal sequence. The tick cannot see CLOCK edges,
+    // so the margins are taken from the worst case: after gating, the last
+    // pulse may take a full period to finish (RMT: until its queue drains),
+    // then DIR_HOLD_US; after the flip, DIR_SETUP_US. Each wait lasts at
+    // least one tick, so both margins are always met.
+    void stepReversal()
+    {
+        switch (revPhase)
+        {
+        case REV_DECEL:
+            // Ramp settled at REVERSAL_HZ (or at a lower target): pause the clock.
+            if (!rampActive)
+            {
+                revHz = currentHz;
+                setClock(0);
+                revUntilUs = lastTickUs + (revHz ? 1000000 / revHz + 1 : 0) + DIR_HOLD_US;
+                revPhase = REV_HOLD;
+            }
+            break;
+
+        case REV_HOLD:
+            if (lastTickUs >= revUntilUs && (backend != PULSE_RMT || rmt.frequency() == 0))
+            {
+                dirApplied = dirCW.load();
+                applyOutputs();
+                revUntilUs = lastTickUs + DIR_SETUP_US;
+                revPhase = REV_SETUP;
+            }
+            break;
+
+        case REV_SETUP:
+            if (lastTickUs >= revUntilUs)
+            {
+                // Resume where we paused and ramp back up to the target.
+                uint32_t hz = revHz;
+                if (hz == 0)
+                    hz = (targetHz < prof.startHz) ? (uint32_t)targetHz : prof.startHz;
+                ramp.reset(hz);
+                setClock(hz);
+                rampActive = true;
+                rampLastUs = lastTickUs;
+                revPhase = REV_NONE;
+#if DEBUG_MOTOR
+                Serial.println("Reversal done");
+#endif
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // Jump to the profile start Hz (or a lower target) and ramp up from there,
+    // arming the start timeout when the profile has FG.
+    void beginRun()
+    {
+        uint32_t target = targetHz;
+        startTimeoutFired = false;
+        fgLossFired = false;
+        if (!releaseLdTrip())
+            return;
+        revPhase = REV_NONE;
+
+        ramp.reset(target < prof.startHz ? target : prof.startHz);
+        rampActive = true;
+        rampLastUs = esp_timer_get_time();
+
+        if (prof.hasFG)
+        {
+            startTimeoutActive = true;
+            startTimeoutStart  = millis();
+        }
+
+        // Cut the output first: on a restart the direction pin changes here.
+        setClock(0);
+        dirApplied = dirCW.load();
+        applyOutputs();
+    }
+
+    // LD level read straight from the GPIO register (ISR-safe).
+    bool IRAM_ATTR ldAsserted() const
+    {
+        int v = gpio_ll_get_level(&GPIO, PIN_LD);
+        return prof.ldActiveLow ? (v == 0) : (v != 0);
+    }
+
+    // Attach/detach the LD interrupt on the asserting edge of the profile.
+    void setLdIsr(bool on)
+    {
+        if (on == ldIsrOn)
+            return;
+        if (on)
+            attachInterruptArg(digitalPinToInterrupt(PIN_LD), isrLD, this,
+                               prof.ldActiveLow ? FALLING : RISING);
+        else
+            detachInterrupt(digitalPinToInterrupt(PIN_LD));
+        ldIsrOn = on;
+    }
+
+    // Hand CLOCK back to the backend after an LD trip. LD may have come back
+    // while the gate was reopened, with its edge unseen (the ISR skips a gate
+    // it still sees closed): trip again then, and return false.
+    bool releaseLdTrip()
+    {
+        if (!ldTrip)
+            return true;
+        ldTrip = false;
+        clockGate.open();
+        if (prof.hasLD && ldAsserted())
+        {
+            isrLD(this);
+            return false;
+        }
+        return true;
+    }
+
+    // A start request: during a ramped stop in the same direction the motor
+    // simply ramps back up from its current speed. With a pending direction
+    // change the stop runs to the end and finishStop() restarts from there.
+    void resumeOrStart()
+    {
+        if (!stopping)
+        {
+            beginRun();
+        }
+        else if (dirCW == dirApplied)
+        {
+            stopping = false;
+            armRamp();
+        }
+    }
+
+    // Begin a ramped stop from the current speed toward 0.
+    void beginDecel()
+    {
+        startTimeoutActive = false;
+        revPhase = REV_NONE;
+        if (!stopping)
+            stopStartUs = lastTickUs;
+
+        if (currentHz == 0)
+        {
+            finishStop(prof.stopMode == STOP_RAMP_BRAKE);
+            return;
+        }
+        armRamp();
+        stopping = true;
+    }
+
+    // Cut the clock and assert STOP; on RMT the queued chunks are dropped
+    // too, or a cut at low Hz would keep stepping for seconds. A positioned
+    // move is only shortened to its deceleration and finishes in
+    // updateRamp().
+    void halt()
+    {
+        startTimeoutActive = false;
+
+        if (moveActive)
+        {
+            rampActive = false;
+            ramp.reset(0);
+            rmt.abortMove();
+            return;
+        }
+
+        rmt.kill();
+        stopStartUs = lastTickUs;
+        finishStop(false);
+    }
+
+    // Emergency stop: no ramp, moves included, and no RMT chunk still
+    // queued goes out.
+    void estop()
+    {
+        startTimeoutActive = false;
+        rmt.kill();
+        stopStartUs = lastTickUs;
+        finishStop(true);
+    }
+
+    // Clock is at (or cut to) 0: assert STOP, optionally the brake, latch a
+    // pending direction change and record the stopping time. A start that
+    // came in during the stop is carried out now.
+    void finishStop(bool engageBrake)
+    {
+        rampActive = false;
+        stopping   = false;
+        revPhase   = REV_NONE;
+        ramp.reset(0);
+        setClock(0);
+        if (engageBrake && prof.hasBrake)
+            brakeOn = true;
+        dirApplied = dirCW.load();
+        applyOutputs();
+        lastStopMs = (uint32_t)((esp_timer_get_time() - stopStartUs) / 1000);
+
+        if (running)
+            beginRun();
+    }
+
+    // Feedback says the motor is not following the clock: the speed loop
+    // (and an autotune test) would only push harder, so open it. A
+    // calibration could not produce anything meaningful either.
+    void dropFeedbackUse()
+    {
+        closedLoop = false;
+        if (autotuning)
+        {
+            tuner.abort();
+            autotuning  = false;
+            rpmWindowMs = RPM_SAMPLE_MS;
+        }
+        if (calibrating)
+        {
+            calib.abort();
+            calibrating = false;
+            rpmWindowMs = RPM_SAMPLE_MS;
+        }
+        // For a sweep, this is the pull-out point.
+        if (sweeping)
+        {
+            sweep.stalled();
+            endSweep();
+        }
+    }
+
+    // One RPM window of the sweep: step the clock, or end the sweep once
+    // it has finished or the motor was stopped.
+    void serviceSweep(uint32_t dtMs, uint32_t hz, uint32_t now)
+    {
+        if (!running)
+            sweep.abort();
+
+        uint32_t next = sweep.update(rawRpmX10, hz, dtMs, now, !rampActive);
+        if (sweep.active())
+        {
+            if (next != targetHz)
+            {
+                targetHz = next;
+                post(REQ_RETARGET);
+            }
+            return;
+        }
+        if (sweep.state() == FreqSweep::SW_DONE)
+        {
+            SkipBand b[SKIP_MAX_BANDS];
+            skipBandsFromCurve(sweep.curve(), b);
+            setSkipBands(b);
+        }
+#if DEBUG_MOTOR
+        Serial.println(sweep.state() == FreqSweep::SW_DONE ? "Sweep done" : "Sweep failed");
+#endif
+        endSweep();
+    }
+
+    // Back to the normal RPM window. The motor may be past pull-out, so it
+    // is stopped, and the next start begins at the first step.
+    void endSweep()
+    {
+        sweeping    = false;
+        rpmWindowMs = RPM_SAMPLE_MS;
+        targetHz    = sweep.firstStepHz();
+        if (running)
+            stop();
+    }
+
+    // One RPM window of the calibration: step the clock, or apply the
+    // result once the calibrator has finished or the motor was stopped.
+    void serviceCalibration(uint32_t pulses, uint32_t dtMs, uint32_t hz, uint32_t now)
+    {
+        if (!running)
+            calib.abort();
+
+        uint32_t next = calib.update(pulses, dtMs, hz, now, !rampActive);
+        if (calib.active())
+        {
+            if (next != targetHz)
+            {
+                targetHz = next;
+                post(REQ_RETARGET);
+            }
+            return;
+        }
+
+        if (calib.state() == FgCalibrator::CAL_DONE)
+        {
+            // Only one of the two follows from the ratio; keep the other.
+            if (prof.clockPerRev > 0)
+            {
+                uint32_t p = calib.pprFor(prof.clockPerRev);
+                if (p)
+                    prof.ppr = (uint8_t)p;
+            }
+            else if (prof.ppr > 0)
+            {
+                prof.clockPerRev = calib.clockPerRevFor(prof.ppr);
+            }
+            slip.configure(prof.clockPerRev);
+            rpmFilter.reset();
+#if DEBUG_MOTOR
+            Serial.print("FG calibration done: edges/clock(ppm)=");
+            Serial.print(calib.edgesPerClockPpm());
+            Serial.print(" dev(%)=");
+            Serial.print(calib.maxDeviationPct());
+            Serial.print(" PPR=");
+            Serial.print(prof.ppr);
+            Serial.print(" clock/rev=");
+            Serial.println(prof.clockPerRev);
+#endif
+        }
+#if DEBUG_MOTOR
+        else
+        {
+            Serial.println("FG calibration failed");
+        }
+#endif
+        endCalibration();
+    }
+
+    // Back to the top frequency and the normal RPM window.
+    void endCalibration()
+    {
+        calibrating = false;
+        rpmWindowMs = RPM_SAMPLE_MS;
+        setTargetHz(calib.topHz());
+    }
+
+    // Response to a newly entered slip tier. WARN is only displayed; DERATE
+    // opens the loop and cuts the clock at once to SLIP_DERATE_KEEP_PCT of
+    // its value, giving the motor a chance to catch up; STALL cuts it off.
+    void onSlipLevel(SlipLevel lvl)
+    {
+        if (lvl >= SLIP_DERATE)
+            dropFeedbackUse();
+
+        if (lvl == SLIP_STALL)
+        {
+            slipStallFired = true;
+            emergencyStop();
+        }
+        else if (lvl == SLIP_DERATE)
+        {
+            targetHz = (uint32_t)((uint64_t)currentHz * SLIP_DERATE_KEEP_PCT / 100);
+            post(REQ_JUMP);
+        }
+
+#if DEBUG_MOTOR
+        Serial.print("Slip ");
+        Serial.print(slip.slipPct());
+        Serial.print("% -> ");
+        Serial.print(lvl == SLIP_STALL ? "STALL" : lvl == SLIP_DERATE ? "DERATE" : "WARN");
+        Serial.print(" after ");
+        Serial.print(slip.tripLatencyMs());
+        Serial.println(" ms");
+#endif
+    }
+
+    // One RPM sample of the autotune test: command the relay output, or
+    // wrap up once the tuner has finished or the motor was stopped.
+    void serviceAutotune(uint32_t now)
+    {
+        if (!running)
+            tuner.abort();
+
+        // Still ramping to the base frequency: let SETTLE wait for it.
+        uint32_t hz = tuner.update(rpm, now, !rampActive);
+        if (tuner.active())
+        {
+            if (hz != targetHz)
+            {
+                targetHz = hz;
+                post(REQ_RETARGET);
+            }
+            return;
+        }
+
+        if (tuner.state() == RelayAutotune::AT_DONE)
+        {
+            prof.kpMilli = tuner.kpMilli();
+            prof.kiMilli = tuner.kiMilli();
+            speedPi.configure(prof.kpMilli, prof.kiMilli);
+#if DEBUG_MOTOR
+            Serial.print("Autotune done: Kp(m)=");
+            Serial.print(prof.kpMilli);
+            Serial.print(" Ki(m)=");
+            Serial.print(prof.kiMilli);
+            Serial.print(" Tu(ms)=");
+            Serial.print(tuner.tuMs());
+            Serial.print(" a(RPM)=");
+            Serial.println(tuner.amplitudeRpm());
+#endif
+        }
+#if DEBUG_MOTOR
+        else
+        {
+            Serial.println("Autotune failed");
+        }
+#endif
+        endAutotune();
+    }
+
+    // Setpoint 'hz' moved out of a skip band (see skipBandAdjust()). Tests
+    // that step the clock themselves (autotune, calibration, sweep) keep
+    // their frequencies, and the ramp still crosses bands between them.
+    uint32_t skipTarget(uint32_t hz, int dir) const
+    {
+        if (autotuning || calibrating || sweeping)
+            return hz;
+        return skipBandAdjust(prof.skip, hz, dir);
+    }
+
+    // Replace the skip bands; the tick reads them, so it is held meanwhile.
+    void setSkipBands(const SkipBand *b)
+    {
+        parkTick();
+        memcpy(prof.skip, b, sizeof(prof.skip));
+        resumeTick();
+        skipBandsChanged = true;
+    }
+
+    // A resonance found while running: a band of +/-SKIP_LIVE_BAND_PCT
+    // around 'hz', and the target leaves it for the nearer edge.
+    void addLiveSkipBand(uint32_t hz)
+    {
+        // Already known (e.g. the closed loop holds a speed inside it).
+        if (skipBandAdjust(prof.skip, hz, 0) != hz)
+            return;
+        uint32_t d = hz * SKIP_LIVE_BAND_PCT / 100;
+        if (d == 0)
+            d = 1;
+        SkipBand b[SKIP_MAX_BANDS];
+        memcpy(b, prof.skip, sizeof(b));
+        if (!skipBandAdd(b, hz - d, hz + d))
+        {
+#if DEBUG_MOTOR
+            Serial.println("Resonance found, but no free skip band");
+#endif
+            return;
+        }
+        setSkipBands(b);
+        setTargetHz(skipBandAdjust(prof.skip, targetHz, 0));
+#if DEBUG_MOTOR
+        Serial.print("Resonance at ");
+        Serial.print(hz);
+        Serial.println(" Hz: skip band added");
+#endif
+    }
+
+    // Spread of the edge-to-edge intervals of the last period-mode window,
+    // as a % of the mean interval (0 with fewer than 3 edges).
+    uint32_t fgPeriodSpreadPct() const
+    {
+        const PeriodStats &s = edgeWin.period;
+        if (s.count() < 2 || edgeWin.dropped || s.meanUs() == 0)
+            return 0;
+        return (uint32_t)((uint64_t)(s.maxUs() - s.minUs()) * 100 / s.meanUs());
+    }
+
+    // Back to the base frequency and the normal RPM window.
+    void endAutotune()
+    {
+        autotuning  = false;
+        rpmWindowMs = RPM_SAMPLE_MS;
+        setTargetHz(tuner.baseHz());
+    }
+
+    // FG pulses since the previous call, from the PCNT total or, on the
+    // fallback path, from the ISR edge count.
+    uint32_t takeFgPulses()
+    {
+        uint32_t c = fgHw ? fgCounter.count() : (uint32_t)fgPulses;
+        uint32_t p = c - lastFgCount;
+        lastFgCount = c;
+        return p;
+    }
+
+    // FG pulses in the current window, without closing it.
+    uint32_t peekFgPulses()
+    {
+        return (fgHw ? fgCounter.count() : (uint32_t)fgPulses) - lastFgCount;
+    }
+
+    // RPM estimate from one sample window of 'pulses' FG edges over 'dtMs'.
+    //  - Count:  pulses / window. Resolution is 60/PPR RPM per window-second,
+    //            fine at speed, useless near standstill.
+    //  - Period: the ISR timestamps every edge; n edges between the last
+    //            edge of the previous window and the last of this one span
+    //            exactly n periods, so the resolution is the timer's 1 us.
+    //            With no edge in the window the speed can be at most one
+    //            period per time-since-last-edge, and 0 after
+    //            FG_ZERO_TIMEOUT_MS.
+    // With PCNT, the edge interrupt is only enabled below FG_PERIOD_MAX_HZ
+    // (hysteresis 3/4); the per-edge ISR fallback always uses the period.
+    //
+    // Confidence: 100 for a window holding 'minPulses' edges, proportionally
+    // less for fewer, minus the +/-1 edge quantization (100/n %) of the count
+    // method. A window without edges is 0 while the value is only an upper
+    // bound, and 100 once it is a definite 0 (timeout or empty full window).
+    RpmReading measureRpm(uint32_t pulses, uint32_t dtMs, uint32_t minPulses)
+    {
+        const uint64_t ppr = prof.ppr;
+        uint32_t countX10 = (uint32_t)(((uint64_t)pulses * 600000ULL) / (ppr * dtMs));
+        uint32_t rate = (uint32_t)((uint64_t)pulses * 1000 / dtMs);   // edges/s
+
+        uint32_t conf  = pulses >= minPulses ? 100 : pulses * 100 / minPulses;
+        uint32_t quant = pulses ? 100 / pulses : 0;
+        if (pulses == 0)
+            conf = 100;            // Full window, no edge: a definite 0
+        RpmReading r = {countX10, 0, (uint8_t)(conf > quant ? conf - quant : 0)};
+
+        if (fgHw)
+        {
+            if (!fgPeriodMode && rate < FG_PERIOD_MAX_HZ * 3 / 4)
+                setFgEdgeIsr(true);
+            else if (fgPeriodMode && rate > FG_PERIOD_MAX_HZ)
+                setFgEdgeIsr(false);
+        }
+        if (!fgPeriodMode)
+            return r;
+
+        EdgeWindow w = drainFgEdges();
+        edgeWin = w;
+
+        // Missing edges would stretch the measured span: start over.
+        if (w.dropped)
+        {
+            fgPeriodPrimed = false;
+            return r;
+        }
+
+        if (w.n > 0)
+        {
+            // n periods since the reference edge (the last edge of the
+            // previous window, or this window's first edge after a restart).
+            uint32_t n = w.n;
+            if (!fgPeriodPrimed)
+            {
+                fgPeriodPrimed = true;
+                fgRefUs = w.firstUs;
+                n--;
+            }
+            uint32_t spanUs = w.lastUs - fgRefUs;
+            fgRefUs = w.lastUs;
+            if (n == 0 || spanUs == 0)
+                return r;
+            r.rpmX10 = (uint32_t)((uint64_t)n * 600000000ULL / (ppr * spanUs));
+            r.confidence = (uint8_t)(n >= minPulses ? 100 : n * 100 / minPulses);
+            return r;
+        }
+
+        // No edge in this window: bound the speed by the time since the last one.
+        uint32_t sinceUs = (uint32_t)esp_timer_get_time() - fgRefUs;
+        if (!fgPeriodPrimed || sinceUs >= (uint32_t)FG_ZERO_TIMEOUT_MS * 1000)
+        {
+            fgPeriodPrimed = false;   // Re-reference on the next edges, not across the gap
+            r.rpmX10 = 0;
+            r.confidence = 100;
+            return r;
+        }
+        uint32_t boundX10 = (uint32_t)(600000000ULL / (ppr * sinceUs));
+        r.rpmX10 = boundX10 < rawRpmX10 ? boundX10 : rawRpmX10;
+        r.confidence = 0;
+        return r;
+    }
+
+    // Analysis stage: drain the edge timestamps the ISR queued since the
+    // last call. Runs in loop(); the ISR is never blocked or masked.
+    EdgeWindow drainFgEdges()
+    {
+        EdgeWindow w = {};
+        uint32_t drops = fgEdges.dropped();
+        w.dropped = (drops != fgEdgeDrops);
+        fgEdgeDrops = drops;
+
+        uint32_t t;
+        while (fgEdges.pop(t))
+        {
+            if (w.n == 0)
+            {
+                w.firstUs = t;
+            }
+            else
+            {
+                w.period.add(t - w.lastUs);
+            }
+            w.lastUs = t;
+            w.n++;
+        }
+        return w;
+    }
+
+    // Turn the FG edge interrupt (period timestamps) on or off. Without
+    // PCNT it also does the counting and stays on.
+    void setFgEdgeIsr(bool on)
+    {
+        if (on == fgPeriodMode)
+            return;
+        if (on)
+        {
+            // Stale timestamps from an earlier period-mode stint would
+            // span the gap; start from an empty ring.
+            fgEdges.clear();
+            fgEdgeDrops = fgEdges.dropped();
+            attachInterrupt(digitalPinToInterrupt(PIN_FG), isrFG, RISING);
+        }
+        else
+            detachInterrupt(digitalPinToInterrupt(PIN_FG));
+        fgPeriodMode   = on;
+        fgPeriodPrimed = false;
+
+#if DEBUG_MOTOR
+        Serial.println(on ? "RPM: period mode" : "RPM: count mode");
+#endif
+    }
+
+    // Launch the N-pulse move requested by moveSteps().
+    void beginMove()
+    {
+        uint32_t target = targetHz;
+        uint32_t peak = target > clockLimitHz() ? clockLimitHz() : target;
+        rampActive = false;
+        startTimeoutActive = false;
+        if (!releaseLdTrip())
+        {
+            moveActive = false;
+            return;
+        }
+
+        if (!rmt.move(movePulses, peak, prof.startHz, prof.accelHzS, prof.decelHzS))
+        {
+            moveActive = false;
+            running    = false;
+            return;
+        }
+        dirApplied = dirCW.load();
+        applyOutputs();
+
+#if DEBUG_MOTOR
+        Serial.print("Move started: ");
+        Serial.print(movePulses);
+        Serial.print(" pulses @ ");
+        Serial.print(peak);
+        Serial.println(" Hz");
+#endif
+    }
+
+    // Re-arm the ramp toward targetHz. A ramp that was idle restarts from the
+    // actual clock, since the FG guard may have moved it meanwhile.
+    void armRamp()
+    {
+        if (!rampActive)
+        {
+            ramp.reset(currentHz);
+            rampLastUs = esp_timer_get_time();
+        }
+        rampActive = true;
+    }
+
+    // Keep the motion tick away from the motor state while loop() changes it
+    // directly (profile switch). The timer keeps firing; ticks just return.
+    void parkTick()
+    {
+        if (!tickTimer)
+            return;
+        parked  = false;
+        parkReq = true;
+        while (!parked)
+            delay(1);
+    }
+
+    void resumeTick() { parkReq = false; }
+
+    // Attach LEDC to PIN_CLOCK on a fixed channel so we know which timer drives
+    // it. We start at 1 kHz; setClock() then retunes that timer (divider and
+    // resolution) in place and never detaches the pin while LEDC is in use.
+    void attachLedcClock()
+    {
+        clockSetting = ClockSolver::solve(1000);
+        ledcAttachChannel(PIN_CLOCK, 1000, clockSetting.bits, LEDC_CH_CLOCK);
+        writeClockDuty(0);               // Duty 0% (motor stopped)
+        clockGated = true;
+    }
+
+    // Hand PIN_CLOCK over to the requested backend. Falls back to LEDC if the
+    // RMT channel cannot be created.
+    void selectBackend(PulseBackend b)
+    {
+        if (b == backend)
+            return;
+
+        if (b == PULSE_RMT)
+        {
+            ledcDetach(PIN_CLOCK);
+            if (rmt.begin(PIN_CLOCK))
+            {
+                backend = PULSE_RMT;
+            }
+            else
+            {
+                attachLedcClock();
+#if DEBUG_MOTOR
+                Serial.println("RMT pulse engine unavailable - using LEDC");
+#endif
+            }
+        }
+        else
+        {
+            rmt.end();
+            attachLedcClock();
+            backend = PULSE_LEDC;
+        }
+    }
+
+    // Write a raw duty value to the CLOCK channel (applied at the next period).
+    void writeClockDuty(uint32_t duty)
+    {
+        if (backend == PULSE_RMT)
+        {
+            if (duty == 0)
+                rmt.setFrequency(0);
+            return;
+        }
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)LEDC_CH_CLOCK, duty);
+        ledc_update_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)LEDC_CH_CLOCK);
+    }
+
+    // LD fault interrupt (see ldTripped())
+    ClockGate   clockGate;           // Forces PIN_CLOCK low on an LD trip
+    bool        ldIsrOn = false;     // isrLD attached
+    std::atomic<bool> ldTrip{false}; // Trip latched, CLOCK gated
+    // Last trip, written by isrLD() and read through ldFault(). Atomic
+    // fields under a sequence lock (odd while written, two steps per trip);
+    // the 64-bit time is split in two halves, as a 64-bit atomic is not
+    // lock-free here.
+    std::atomic<uint32_t> ldSeq{0};
+    std::atomic<uint32_t> ldAtUsLo{0}, ldAtUsHi{0};
+    std::atomic<uint32_t> ldHz{0}, ldRpmX10{0};
+
+    // FG counting: PCNT unit, or the ISR counter (volatile) as a fallback.
+    FgCounter   fgCounter;
+    bool        fgHw = false;        // true: fgCounter owns PIN_FG
+    uint32_t    lastFgCount = 0;     // Edge total at the previous sample
+    static volatile uint32_t fgPulses;  // Edges seen by the ISR (free running)
+    static SpscRing<uint32_t, FG_EDGE_RING> fgEdges;  // Edge timestamps (us), ISR -> loop
+
+    // Period measurement (FG edge ISR enabled)
+    bool        fgPeriodMode = false;   // true: isrFG attached
+    bool        fgPeriodPrimed = false; // fgRefUs holds a valid reference edge
+    uint32_t    fgRefUs    = 0;         // Timestamp of the reference (last seen) edge
+    uint32_t    fgEdgeDrops = 0;        // fgEdges.dropped() at the last drain
+    EdgeWindow  edgeWin = {};        // Last drained window
+    JitterSummary jitterRun = {};    // Interval CVs since resetFgJitter()
 
     // Timing for RPM sampling, preferences handle, and persisted flags.
     uint32_t    lastRpmSample = 0;
-    uint32_t    lastRampTick  = 0;   // Last ramp tick timestamp
+    uint32_t    lastTelemetryMs = 0;
+    RpmReading  reading = {0, 0, 0};  // Latest estimate (see rpmReading())
+    uint32_t    rawRpmX10 = 0;       // Same, before the filter chain
+    RpmFilter   rpmFilter;           // Per-profile RPM filter chain
+    SlipMonitor slip;                // Expected vs measured speed
+    ResonanceWatch resWatch;         // Live resonance check (FG period spread)
+    std::atomic<bool> skipBandsChanged{false}; // prof.skip changed, not yet persisted
+    uint32_t    slipHzStart = 0;     // Clock at the start of the RPM window
+    bool        slipRun = false;     // running as of the previous sample
+
+    // FG watchdog (motion tick side; the ratio is published by loop())
+    std::atomic<uint32_t> fgWdRatioQ16{0}; // Q16 tenths of RPM per clock Hz
+    uint32_t    fgWdLastCount  = 0;  // fgEdgeCount() at the last seen edge
+    int64_t     fgWdLastEdgeUs = 0;  // Tick time at which it changed
+    std::atomic<uint32_t> fgWdLatencyUs{0};  // Last trip: silence before the cut
+    std::atomic<uint32_t> fgWdDeadlineUs{0}; // Last trip: deadline in force
+    std::atomic<uint32_t> fgWdTrips{0};
+    SCurveRamp  ramp;                // Jerk-limited Hz trajectory
+    SpeedPI     speedPi;             // Closed-loop speed controller (loop() side)
+    std::atomic<bool> closedLoop{false}; // true: regulate targetRpm via speedPi
+    uint32_t    targetRpm  = 0;      // RPM setpoint in closed loop
+    RelayAutotune tuner;             // Speed-loop autotune (loop() side)
+    std::atomic<bool> autotuning{false}; // true while tuner drives targetHz
+    FgCalibrator calib;              // FG/clock ratio calibration (loop() side)
+    std::atomic<bool> calibrating{false}; // true while calib drives targetHz
+    FreqSweep   sweep;               // Hz-to-RPM sweep (loop() side)
+    std::atomic<bool> sweeping{false}; // true while sweep drives targetHz
+    uint32_t    rpmWindowMs = RPM_SAMPLE_MS; // Current RPM sampling window
+    int64_t     rampLastUs = 0;      // Time base of the last ramp step (us)
     Preferences sysPrefs;
-    bool        telemetryOn = false;
+
+    // Motion tick state
+    esp_timer_handle_t    tickTimer = nullptr;
+    std::atomic<uint32_t> pendingReq{0};       // REQ_* bits posted by loop()
+    std::atomic<bool>     parkReq{false}, parked{false};
+    std::atomic<uint32_t> tickJitterMaxUs{0};  // Worst |period - MOTION_TICK_US|
+    std::atomic<bool>     stopping{false};     // Ramped stop in progress
+    std::atomic<bool>     dirApplied{true};    // Level on PIN_DIR (latched by the tick)
+    std::atomic<uint32_t> lastStopMs{0};       // Duration of the last stop
+    int64_t     stopStartUs = 0;     // When the current stop was taken up
+    std::atomic<uint8_t> revPhase{REV_NONE}; // Direction reversal state (RevPhase)
+    uint32_t    revHz       = 0;     // Speed at which the clock was paused
+    int64_t     revUntilUs  = 0;     // End of the current hold/setup wait
+    int64_t     lastTickUs = 0;      // Timestamp of the previous tick
+    uint32_t    movePulses = 0;      // Pulse count handed over with REQ_MOVE
+
+    bool        clockGated  = true;  // true while CLOCK duty is held at 0%
+    ClockSetting clockSetting = {};  // Divider/resolution currently in the timer
+    PulseBackend backend = PULSE_LEDC; // Peripheral currently driving PIN_CLOCK
+    RmtPulseEngine rmt;              // Pulse engine (owns the pin when backend == PULSE_RMT)
+    std::atomic<uint8_t> teleMode{TELE_OFF}; // TelemetryMode
+    SpscRing<TelemetryRecord, TELEM_RING> teleRing; // Binary records, tick -> loop()
+    uint32_t    teleTicks = 0;       // Ticks since the last record (tick side)
+    uint16_t    teleSeq = 0;         // Next record number (tick side)
+    bool        teleGap = false;     // Last record was dropped (tick side)
+    bool        teleSync = true;     // Send a delimiter before the next frame
     Language    lang = LANG_ES;
 };
 
 // -------- Static members & ISR definitions --------
 volatile uint32_t MotorRuntime::fgPulses = 0;
+SpscRing<uint32_t, FG_EDGE_RING> MotorRuntime::fgEdges;
+
+void IRAM_ATTR MotorRuntime::isrLD(void *arg)
+{
+    MotorRuntime *m = (MotorRuntime *)arg;
+
+    // Only act on a level that is still there (spike rejection).
+    if (!m->ldAsserted())
+        return;
+
+    m->clockGate.close();
+    if (m->prof.hasStop)
+        gpio_ll_set_level(&GPIO, PIN_STOP, m->prof.stopActiveHigh ? 1 : 0);
+    m->running = false;
+    m->pendingReq.fetch_or(REQ_ESTOP);
+
+    // Odd sequence while the record is written (see ldFault()).
+    m->ldSeq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    uint64_t t = (uint64_t)esp_timer_get_time();
+    m->ldAtUsLo.store((uint32_t)t, std::memory_order_relaxed);
+    m->ldAtUsHi.store((uint32_t)(t >> 32), std::memory_order_relaxed);
+    m->ldHz.store(m->currentHz.load(), std::memory_order_relaxed);
+    m->ldRpmX10.store(m->rpmX10.load(), std::memory_order_relaxed);
+    m->ldSeq.fetch_add(1, std::memory_order_release);
+    m->ldTrip = true;
+}
 
 void IRAM_ATTR MotorRuntime::isrFG()
 {
+    fgEdges.push((uint32_t)esp_timer_get_time());
     fgPulses++;
 }
@@ -0,0 +1,85 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>
+#include "Config.h"
+
+// ================================ PeriodStats ===============================
+// Streaming min, max, mean and variance of the FG edge-to-edge period (us),
+// Welford's method: one pass, fixed memory, no sum of squares to cancel.
+//
+//   n += 1;  d = x - mean;  mean += d / n;  m2 += d * (x - mean)
+//   variance = m2 / (n - 1)
+//
+// Float is enough here: the S3 has a single-precision FPU, and the update
+// runs in loop() (drainFgEdges()), never in the ISR.
+class PeriodStats
+{
+public:
+    void reset()
+    {
+        n    = 0;
+        mean = 0.0f;
+        m2   = 0.0f;
+        lo   = 0;
+        hi   = 0;
+    }
+
+    void add(uint32_t us)
+    {
+        n++;
+        float x = (float)us;
+        float d = x - mean;
+        mean += d / n;
+        m2   += d * (x - mean);
+        if (n == 1 || us < lo) lo = us;
+        if (us > hi) hi = us;
+    }
+
+    uint32_t count() const { return n; }
+    uint32_t minUs() const { return lo; }      // 0 with no interval
+    uint32_t maxUs() const { return hi; }
+    uint32_t meanUs() const { return (uint32_t)(mean + 0.5f); }
+    float    variance() const { return n > 1 ? m2 / (n - 1) : 0.0f; }
+    uint32_t stdDevUs() const { return (uint32_t)(sqrtf(variance()) + 0.5f); }
+
+    // Coefficient of variation (standard deviation / mean), per mille.
+    uint32_t cvPermille() const
+    {
+        return (n > 1 && mean > 0.0f) ? (uint32_t)(sqrtf(variance()) * 1000.0f / mean + 0.5f) : 0;
+    }
+
+private:
+    uint32_t n = 0;
+    float    mean = 0.0f;
+    float    m2 = 0.0f;       // Sum of squared deviations from the mean
+    uint32_t lo = 0, hi = 0;
+};
+
+// =============================== JitterSummary ==============================
+// The period jitter of a run (e.g. an auto test), for reports: the CV of
+// each steady RPM window with at least FG_JITTER_MIN_PERIODS intervals. The
+// windows are at different speeds, so their CVs are summarized rather than
+// their periods pooled. worn() flags a motor whose mean CV reaches
+// FG_JITTER_WORN_PERMILLE over at least FG_JITTER_MIN_WINDOWS windows.
+struct JitterSummary
+{
+    uint32_t windows;   // Windows counted
+    uint32_t sumCv;     // Sum of their CVs (per mille)
+    uint32_t maxCv;     // Worst window CV (per mille)
+
+    void reset() { windows = 0; sumCv = 0; maxCv = 0; }
+
+    void add(const PeriodStats &s)
+    {
+        if (s.count() < FG_JITTER_MIN_PERIODS)
+            return;
+        uint32_t cv = s.cvPermille();
+        windows++;
+        sumCv += cv;
+        if (cv > maxCv) maxCv = cv;
+    }
+
+    uint32_t meanCv() const { return windows ? sumCv / windows : 0; }
+    bool     valid() const { return windows >= FG_JITTER_MIN_WINDOWS; }
+    bool     worn() const { return valid() && meanCv() >= FG_JITTER_WORN_PERMILLE; }
+};
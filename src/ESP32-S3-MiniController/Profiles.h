@@ -2,10 +2,30 @@
 #include <Arduino.h>
 #include <Preferences.h>
 #include "Config.h"
+#include "ClockSolver.h"
+#include "PulseEngine.h"
+#include "Sweep.h"
+#include "SkipBands.h"
+
+// CLOCK generator used by a profile.
+enum PulseBackend : uint8_t
+{
+  PULSE_LEDC = 0,   // Free-running LEDC PWM (default)
+  PULSE_RMT  = 1    // Streamed RMT pulses: exact counts and N-pulse moves
+};
+
+// How MotorRuntime::stop() brings the motor to rest.
+enum StopMode : uint8_t
+{
+  STOP_CUT        = 0,  // Cut the clock at once and assert STOP
+  STOP_RAMP       = 1,  // Decelerate to zero first, then assert STOP (default)
+  STOP_RAMP_BRAKE = 2   // As STOP_RAMP, then engage the brake (if present)
+};
 
 // ------------------------------ MotorProfile ------------------------------
 // Describes a motor profile: capabilities (brake, FG, LD, stop, enable),
-// signal polarities, tachometer PPR, and a safety cap for the clock (Hz).
+// signal polarities, tachometer PPR, a safety cap for the clock (Hz), and
+// the speed ramp limits used by the planner and by RMT moves.
 // The name is a short, human-readable label stored alongside.
 struct MotorProfile {
   char   name[20];
@@ -20,6 +40,19 @@ struct MotorProfile {
   uint8_t  ppr;            // Pulses per revolution (tachometer/FG)
   uint32_t maxClockHz;     // Safety limit for the generated clock
   bool   isAdminProfile;   // true = only admin can delete/demote this profile
+  uint8_t  pulseBackend;   // PulseBackend used to generate the clock
+  uint32_t accelHzS;       // Ramp acceleration limit (Hz/s)
+  uint32_t decelHzS;       // Ramp deceleration limit (Hz/s)
+  uint32_t startHz;        // Clock jumps here on start, cuts from here on stop
+  uint8_t  stopMode;       // StopMode used by a normal stop
+  uint32_t kpMilli;        // Closed-loop speed Kp (Hz per RPM, x1000)
+  uint32_t kiMilli;        // Closed-loop speed Ki (Hz per RPM*s, x1000)
+  uint8_t  rpmFilter;      // RpmFilterStage mask applied to the RPM estimate
+  uint8_t  filtMedianN;    // Median window (samples)
+  uint8_t  filtAvgN;       // Moving-average window (samples)
+  uint8_t  filtIirAlpha;   // IIR weight of a new sample (/256)
+  uint32_t clockPerRev;    // CLOCK pulses per shaft turn (slip check); 0 = learn
+  SkipBand skip[SKIP_MAX_BANDS]; // Resonance bands the clock does not dwell in
 
   // Initialize with safe, generic defaults.
   void setDefaults() {
@@ -35,6 +68,56 @@ struct MotorProfile {
     ppr = 6;
     maxClockHz = 20000;
     isAdminProfile = false;
+    pulseBackend = PULSE_LEDC;
+    accelHzS = RAMP_ACCEL_HZ_S;
+    decelHzS = RAMP_DECEL_HZ_S;
+    startHz = RAMP_START_HZ;
+    stopMode = STOP_RAMP;
+    kpMilli = SPEED_KP_MILLI;
+    kiMilli = SPEED_KI_MILLI;
+    rpmFilter = RPM_FILT_STAGES;
+    filtMedianN = RPM_FILT_MEDIAN_N;
+    filtAvgN = RPM_FILT_AVG_N;
+    filtIirAlpha = RPM_FILT_IIR_ALPHA;
+    clockPerRev = 0;
+    skipBandsClear(skip);
+  }
+
+  // Clock range the profile's backend can generate (Hz).
+  uint32_t hwMinHz() const {
+    return pulseBackend == PULSE_RMT ? RmtPulseEngine::MIN_HZ : ClockSolver::HW_MIN_HZ;
+  }
+  uint32_t hwMaxHz() const {
+    return pulseBackend == PULSE_RMT ? RmtPulseEngine::MAX_HZ : ClockSolver::HW_MAX_HZ;
+  }
+
+  // Bring fields read back from storage into range: an enum out of range
+  // falls back to its default; PPR, gains, clock pulses per rev and ramp
+  // rates go to the editor range; the clock cap to the editor floor and
+  // what the backend can generate, and the start frequency under it. Skip
+  // bands are put back in order, overlapping ones merged and empty or
+  // inverted ones dropped.
+  void sanitize() {
+    if (pulseBackend > PULSE_RMT) pulseBackend = PULSE_LEDC;
+    if (stopMode > STOP_RAMP_BRAKE) stopMode = STOP_RAMP;
+    if (ppr == 0) ppr = 1;
+    if (kpMilli > SPEED_GAIN_MAX_MILLI) kpMilli = SPEED_GAIN_MAX_MILLI;
+    if (kiMilli > SPEED_GAIN_MAX_MILLI) kiMilli = SPEED_GAIN_MAX_MILLI;
+    if (clockPerRev > SLIP_CLOCK_REV_MAX) clockPerRev = SLIP_CLOCK_REV_MAX;
+    if (maxClockHz < CLOCK_CAP_MIN_HZ) maxClockHz = CLOCK_CAP_MIN_HZ;
+    if (maxClockHz > hwMaxHz()) maxClockHz = hwMaxHz();
+    if (accelHzS < RAMP_RATE_MIN_HZ_S) accelHzS = RAMP_RATE_MIN_HZ_S;
+    if (accelHzS > RAMP_RATE_MAX_HZ_S) accelHzS = RAMP_RATE_MAX_HZ_S;
+    if (decelHzS < RAMP_RATE_MIN_HZ_S) decelHzS = RAMP_RATE_MIN_HZ_S;
+    if (decelHzS > RAMP_RATE_MAX_HZ_S) decelHzS = RAMP_RATE_MAX_HZ_S;
+    if (startHz > maxClockHz) startHz = maxClockHz;
+    if (startHz < hwMinHz()) startHz = hwMinHz();
+
+    SkipBand in[SKIP_MAX_BANDS];
+    memcpy(in, skip, sizeof(in));
+    skipBandsClear(skip);
+    for (uint8_t i = 0; i < SKIP_MAX_BANDS; i++)
+      skipBandAdd(skip, in[i].loHz, in[i].hiHz);
   }
 };
 
@@ -45,7 +128,10 @@ struct MotorProfile {
 //   - "active" : active profile index (0..count-1) or 255 if none
 //   Per-profile keys (for index i):
 //     "mi_name", "mi_br", "mi_fg", "mi_ld", "mi_lda",
-//     "mi_st", "mi_sta", "mi_en", "mi_ena", "mi_ppr", "mi_max"
+//     "mi_st", "mi_sta", "mi_en", "mi_ena", "mi_ppr", "mi_max", "mi_adm", "mi_pb",
+//     "mi_acc", "mi_dec", "mi_sth", "mi_stm", "mi_kp", "mi_ki",
+//     "mi_flt", "mi_fmn", "mi_fan", "mi_fia", "mi_cpr", "mi_skb" (skip band blob)
+//     "mi_crv" : SweepCurve blob (optional, see saveCurve())
 class ProfileStore {
 public:
   // Open the NVS namespace and read the number of profiles and active index.
@@ -60,8 +146,8 @@ public:
   int getCount() const { return count; }
   int getActiveIndex() const { return activeIndex; }
 
-  // Load a profile at index 'idx' into 'm'.
-  // Returns false if the index is out of range.
+  // Load a profile at index 'idx' into 'm', sanitized (see
+  // MotorProfile::sanitize()). Returns false if the index is out of range.
   bool load(int idx, MotorProfile &m) {
     if (idx < 0 || idx >= count) return false;
 
@@ -70,7 +156,8 @@ public:
     // Name (string) and all boolean/numeric fields.
     snprintf(key, sizeof(key), "m%d_name", idx);
     String s = prefs.getString(key, "Unnamed");
-    strncpy(m.name, s.c_str(), sizeof(m.name));
+    strncpy(m.name, s.c_str(), sizeof(m.name) - 1);
+    m.name[sizeof(m.name) - 1] = '\0';
 
     snprintf(key, sizeof(key), "m%d_br", idx);   m.hasBrake         = prefs.getBool(key, false);
     snprintf(key, sizeof(key), "m%d_fg", idx);   m.hasFG            = prefs.getBool(key, false);
@@ -83,7 +170,23 @@ public:
     snprintf(key, sizeof(key), "m%d_ppr", idx);  m.ppr              = prefs.getUChar(key, 6);
     snprintf(key, sizeof(key), "m%d_max", idx);  m.maxClockHz       = prefs.getUInt(key, 20000);
     snprintf(key, sizeof(key), "m%d_adm", idx);  m.isAdminProfile   = prefs.getBool(key, false);
+    snprintf(key, sizeof(key), "m%d_pb", idx);   m.pulseBackend     = prefs.getUChar(key, PULSE_LEDC);
+    snprintf(key, sizeof(key), "m%d_acc", idx);  m.accelHzS         = prefs.getUInt(key, RAMP_ACCEL_HZ_S);
+    snprintf(key, sizeof(key), "m%d_dec", idx);  m.decelHzS         = prefs.getUInt(key, RAMP_DECEL_HZ_S);
+    snprintf(key, sizeof(key), "m%d_sth", idx);  m.startHz          = prefs.getUInt(key, RAMP_START_HZ);
+    snprintf(key, sizeof(key), "m%d_stm", idx);  m.stopMode         = prefs.getUChar(key, STOP_RAMP);
+    snprintf(key, sizeof(key), "m%d_kp", idx);   m.kpMilli          = prefs.getUInt(key, SPEED_KP_MILLI);
+    snprintf(key, sizeof(key), "m%d_ki", idx);   m.kiMilli          = prefs.getUInt(key, SPEED_KI_MILLI);
+    snprintf(key, sizeof(key), "m%d_flt", idx);  m.rpmFilter        = prefs.getUChar(key, RPM_FILT_STAGES);
+    snprintf(key, sizeof(key), "m%d_fmn", idx);  m.filtMedianN      = prefs.getUChar(key, RPM_FILT_MEDIAN_N);
+    snprintf(key, sizeof(key), "m%d_fan", idx);  m.filtAvgN         = prefs.getUChar(key, RPM_FILT_AVG_N);
+    snprintf(key, sizeof(key), "m%d_fia", idx);  m.filtIirAlpha     = prefs.getUChar(key, RPM_FILT_IIR_ALPHA);
+    snprintf(key, sizeof(key), "m%d_cpr", idx);  m.clockPerRev      = prefs.getUInt(key, 0);
+    snprintf(key, sizeof(key), "m%d_skb", idx);
+    if (!prefs.isKey(key) || prefs.getBytes(key, m.skip, sizeof(m.skip)) != sizeof(m.skip))
+      skipBandsClear(m.skip);
 
+    m.sanitize();
     return true;
   }
 
@@ -106,6 +209,19 @@ public:
     snprintf(key, sizeof(key), "m%d_ppr",  idx); prefs.putUChar (key, m.ppr);
     snprintf(key, sizeof(key), "m%d_max",  idx); prefs.putUInt  (key, m.maxClockHz);
     snprintf(key, sizeof(key), "m%d_adm",  idx); prefs.putBool  (key, m.isAdminProfile);
+    snprintf(key, sizeof(key), "m%d_pb",   idx); prefs.putUChar (key, m.pulseBackend);
+    snprintf(key, sizeof(key), "m%d_acc",  idx); prefs.putUInt  (key, m.accelHzS);
+    snprintf(key, sizeof(key), "m%d_dec",  idx); prefs.putUInt  (key, m.decelHzS);
+    snprintf(key, sizeof(key), "m%d_sth",  idx); prefs.putUInt  (key, m.startHz);
+    snprintf(key, sizeof(key), "m%d_stm",  idx); prefs.putUChar (key, m.stopMode);
+    snprintf(key, sizeof(key), "m%d_kp",   idx); prefs.putUInt  (key, m.kpMilli);
+    snprintf(key, sizeof(key), "m%d_ki",   idx); prefs.putUInt  (key, m.kiMilli);
+    snprintf(key, sizeof(key), "m%d_flt",  idx); prefs.putUChar (key, m.rpmFilter);
+    snprintf(key, sizeof(key), "m%d_fmn",  idx); prefs.putUChar (key, m.filtMedianN);
+    snprintf(key, sizeof(key), "m%d_fan",  idx); prefs.putUChar (key, m.filtAvgN);
+    snprintf(key, sizeof(key), "m%d_fia",  idx); prefs.putUChar (key, m.filtIirAlpha);
+    snprintf(key, sizeof(key), "m%d_cpr",  idx); prefs.putUInt  (key, m.clockPerRev);
+    snprintf(key, sizeof(key), "m%d_skb",  idx); prefs.putBytes (key, m.skip, sizeof(m.skip));
 
     // If saving beyond current count, grow count and persist it.
     if (idx >= count) {
@@ -127,15 +243,18 @@ public:
     if (idx < 0 || idx >= count) return;
 
     MotorProfile tmp;
+    SweepCurve crv;
     for (int i = idx; i < count - 1; ++i) {
       load(i + 1, tmp);
       save(i, tmp);
+      if (loadCurve(i + 1, crv)) saveCurve(i, crv);
+      else clearCurve(i);
     }
 
     // Clear the tail keys for the last, now-unused slot.
     char key[16];
     int last = count - 1;
-    const char* sfx[] = { "name","br","fg","ld","lda","st","sta","en","ena","ppr","max","adm" };
+    const char* sfx[] = { "name","br","fg","ld","lda","st","sta","en","ena","ppr","max","adm","pb","acc","dec","sth","stm","kp","ki","flt","fmn","fan","fia","cpr","skb","crv" };
     for (auto s : sfx) {
       snprintf(key, sizeof(key), "m%d_%s", last, s);
       prefs.remove(key);
@@ -152,6 +271,28 @@ public:
     }
   }
 
+  // Sweep curve of profile 'idx' (kept apart from MotorProfile, which is
+  // copied around by the UI). Returns false if none is stored.
+  bool loadCurve(int idx, SweepCurve &c) {
+    char key[16];
+    snprintf(key, sizeof(key), "m%d_crv", idx);
+    if (!prefs.isKey(key) || prefs.getBytesLength(key) != sizeof(c)) return false;
+    prefs.getBytes(key, &c, sizeof(c));
+    return c.version == SWEEP_CURVE_VERSION && c.count <= SWEEP_POINTS;
+  }
+
+  void saveCurve(int idx, const SweepCurve &c) {
+    char key[16];
+    snprintf(key, sizeof(key), "m%d_crv", idx);
+    prefs.putBytes(key, &c, sizeof(c));
+  }
+
+  void clearCurve(int idx) {
+    char key[16];
+    snprintf(key, sizeof(key), "m%d_crv", idx);
+    prefs.remove(key);
+  }
+
   // Load the active profile; returns false if none is available.
   bool loadActive(MotorProfile &m) {
     if (count == 0 || activeIndex >= count) return false;
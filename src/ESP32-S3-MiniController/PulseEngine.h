@@ -0,0 +1,390 @@
+#pragma once
+#include <Arduino.h>
+#include <driver/rmt_tx.h>
+#include <esp_timer.h>
+#include "Config.h"
+
+// ============================== RmtPulseEngine ==============================
+// Alternative CLOCK backend built on the RMT peripheral. Instead of a free
+// running PWM, the step pulses are generated one by one from a small ring of
+// symbol buffers that are streamed to the RMT TX channel. Every pulse is
+// accounted for, which allows:
+//   - continuous running at a requested frequency (ramped by MotorRuntime),
+//   - positioned moves of exactly N pulses with accel/decel,
+//   - a 64-bit counter of pulses actually emitted by the hardware.
+//
+// Pulse periods are produced with a phase accumulator, so the mean frequency
+// is exact even when the period is not a whole number of RMT ticks.
+// Buffers are refilled from service(); if it is called late the output pauses
+// between chunks but no pulse is ever lost or duplicated.
+class RmtPulseEngine
+{
+public:
+    // Frequency range of this backend (1 tick high + 1 tick low at the top).
+    static constexpr uint32_t MAX_HZ = RMT_PULSE_RES_HZ / 2;
+    static constexpr uint32_t MIN_HZ = 1;
+
+    // Claim 'pin' with a new RMT TX channel. The pin must not be attached to
+    // LEDC at this point. Returns false if the channel could not be created.
+    bool begin(uint8_t pin)
+    {
+        if (chan)
+            return true;
+
+        rmt_tx_channel_config_t cfg = {};
+        cfg.gpio_num          = pin;
+        cfg.clk_src           = RMT_CLK_SRC_DEFAULT;
+        cfg.resolution_hz     = RMT_PULSE_RES_HZ;
+        cfg.mem_block_symbols = 48;               // One RMT memory block on the S3
+        cfg.trans_queue_depth = RMT_CHUNK_COUNT;  // Every buffer can be queued
+        if (rmt_new_tx_channel(&cfg, &chan) != ESP_OK)
+        {
+            chan = nullptr;
+            return false;
+        }
+
+        rmt_copy_encoder_config_t enc = {};
+        rmt_new_copy_encoder(&enc, &encoder);
+
+        rmt_tx_event_callbacks_t cbs = {};
+        cbs.on_trans_done = onDone;
+        rmt_tx_register_event_callbacks(chan, &cbs, this);
+        rmt_enable(chan);
+
+        head = tail = 0;
+        phaseAcc = 0;
+        contHz = 0;
+        moveMode = false;
+        return true;
+    }
+
+    // Let queued pulses finish, then release the channel and the pin.
+    void end()
+    {
+        if (!chan)
+            return;
+        contHz = 0;
+        moveMode = false;
+        rmt_tx_wait_all_done(chan, 1000);
+        rmt_disable(chan);
+        rmt_del_encoder(encoder);
+        rmt_del_channel(chan);
+        chan = nullptr;
+        encoder = nullptr;
+    }
+
+    bool active() const { return chan != nullptr; }
+
+    // Continuous mode: stream pulses at 'hz'. 0 stops feeding new pulses;
+    // what is already queued (at most RMT_CHUNK_COUNT chunks) still goes out.
+    void setFrequency(uint32_t hz)
+    {
+        if (moveMode)
+            return;
+        contHz = (hz > MAX_HZ) ? MAX_HZ : hz;
+        service();
+    }
+
+    // Positioned move: emit exactly 'n' pulses, accelerating from 'startHz'
+    // to 'peakHz' at 'accelHzS' and decelerating back at 'decelHzS' so the
+    // last pulse is emitted at 'startHz' again. Rates of 0 mean "no ramp".
+    bool move(uint32_t n, uint32_t peakHz, uint32_t startHz, uint32_t accelHzS, uint32_t decelHzS)
+    {
+        if (!chan || moveMode || n == 0 || peakHz == 0)
+            return false;
+
+        if (peakHz > MAX_HZ) peakHz = MAX_HZ;
+        if (startHz == 0 || startHz > peakHz) startHz = peakHz;
+
+        contHz    = 0;
+        moveTotal = n;
+        moveDone  = 0;
+        movePeak  = peakHz;
+        moveStart = startHz;
+        moveAccel = accelHzS;
+        moveDecel = decelHzS;
+        moveMode  = true;
+        service();
+        return true;
+    }
+
+    // Cut a running move short with its normal deceleration: the pulse budget
+    // is reduced to what is needed to slow down from the current frequency.
+    void abortMove()
+    {
+        if (!moveMode)
+            return;
+
+        uint32_t stopPulses = 0;
+        if (moveDecel > 0 && lastHz > moveStart)
+        {
+            uint64_t f2 = (uint64_t)lastHz * lastHz - (uint64_t)moveStart * moveStart;
+            stopPulses = (uint32_t)(f2 / (2ULL * moveDecel));
+        }
+        if (moveTotal - moveDone > stopPulses)
+            moveTotal = moveDone + stopPulses;
+    }
+
+    // Stop generating pulses at once, in continuous mode and in a move alike.
+    // Chunks already queued still go out and are counted; a move then ends
+    // as soon as they have left. A chunk holds at least one pulse, so at a
+    // few Hz that is whole seconds of pulses: see kill().
+    void halt()
+    {
+        contHz = 0;
+        if (moveMode)
+            moveTotal = moveDone;
+    }
+
+    // Emergency cut: no pulse leaves after this returns. rmt_disable() stops
+    // the chunk being sent where it is and recycles it and the queued ones
+    // without their done callback; the pulses of the cut chunk that had
+    // already started are counted from the time it started. The channel is
+    // re-enabled at once, idle, and a move is over.
+    void kill()
+    {
+        if (!chan)
+            return;
+        contHz = 0;
+        rmt_disable(chan);
+
+        int64_t nowUs = esp_timer_get_time();
+        portENTER_CRITICAL(&mux);
+        if (head != tail)
+            emitted += pulsesStarted(tail % RMT_CHUNK_COUNT, nowUs - chunkStartUs);
+        head = tail;
+        portEXIT_CRITICAL(&mux);
+
+        phaseAcc = 0;
+        moveMode = false;
+        rmt_enable(chan);
+    }
+
+    // True while a positioned move still has pulses to generate or in flight.
+    bool moving() const { return moveMode; }
+    uint32_t moveRemaining() const { return moveMode ? moveTotal - moveDone : 0; }
+
+    // Frequency of the most recently generated pulse (0 once drained).
+    uint32_t frequency() const { return (head == tail) ? 0 : lastHz; }
+
+    // Number of pulses emitted by the hardware since power-up: exact from
+    // the done callbacks, and for a chunk cut by kill() reckoned from its
+    // start time (off by one at most if the callback ran late).
+    uint64_t emittedPulses() const
+    {
+        portENTER_CRITICAL(&mux);
+        uint64_t v = emitted;
+        portEXIT_CRITICAL(&mux);
+        return v;
+    }
+
+    // Refill and queue every free chunk buffer. Call as often as possible.
+    void service()
+    {
+        if (!chan)
+            return;
+
+        while ((uint32_t)(head - tail) < RMT_CHUNK_COUNT)
+        {
+            uint8_t slot = head % RMT_CHUNK_COUNT;
+            uint32_t pulses = 0;
+            size_t used = fillChunk(buffers[slot], pulses);
+            if (used == 0)
+                break;
+
+            chunkPulses[slot] = pulses;
+            chunkSymbols[slot] = (uint16_t)used;
+            if (head == tail)
+                chunkStartUs = esp_timer_get_time();   // Starts at once
+            rmt_transmit_config_t tx = {};
+            tx.loop_count = 0;
+            if (rmt_transmit(chan, encoder, buffers[slot], used * sizeof(rmt_symbol_word_t), &tx) != ESP_OK)
+                break;
+            head++;
+        }
+
+        // A move is over once every pulse was generated and has left the RMT.
+        if (moveMode && moveDone >= moveTotal && head == tail)
+            moveMode = false;
+    }
+
+private:
+    // Integer square root, used for the constant-acceleration pulse profile.
+    static uint32_t isqrt64(uint64_t v)
+    {
+        uint64_t r = 0, bit = 1ULL << 62;
+        while (bit > v)
+            bit >>= 2;
+        while (bit)
+        {
+            if (v >= r + bit)
+            {
+                v -= r + bit;
+                r = (r >> 1) + bit;
+            }
+            else
+            {
+                r >>= 1;
+            }
+            bit >>= 2;
+        }
+        return (uint32_t)r;
+    }
+
+    // Frequency of move pulse number 'moveDone' (v^2 = v0^2 + 2*a*s on both ramps).
+    uint32_t movePulseHz() const
+    {
+        uint32_t hz = movePeak;
+        uint64_t f02 = (uint64_t)moveStart * moveStart;
+        if (moveAccel > 0)
+        {
+            uint32_t up = isqrt64(f02 + 2ULL * moveAccel * moveDone);
+            if (up < hz) hz = up;
+        }
+        if (moveDecel > 0)
+        {
+            uint32_t down = isqrt64(f02 + 2ULL * moveDecel * (moveTotal - 1 - moveDone));
+            if (down < hz) hz = down;
+        }
+        return hz;
+    }
+
+    // Number of RMT symbols a pulse of 'period' ticks needs.
+    static size_t symbolsFor(uint32_t period)
+    {
+        const uint32_t MAX_SYM = 2 * 32767;
+        return (period <= MAX_SYM) ? 1 : 1 + (period - MAX_SYM + MAX_SYM - 1) / MAX_SYM;
+    }
+
+    // Encode one pulse: high for half the period (max one symbol half), low
+    // for the rest, padded with low-only symbols for long periods. Durations
+    // are never 0, since a zero duration marks the end of an RMT transfer.
+    static size_t encodePulse(rmt_symbol_word_t *out, uint32_t period)
+    {
+        uint32_t high = period / 2;
+        if (high > 32767) high = 32767;
+        uint32_t low = period - high;
+        uint32_t first = (low > 32767) ? 32767 : low;
+        uint32_t rest = low - first;
+        if (rest == 1)
+        {
+            first--;
+            rest = 2;
+        }
+
+        size_t n = 0;
+        out[n].level0 = 1; out[n].duration0 = high;
+        out[n].level1 = 0; out[n].duration1 = first;
+        n++;
+        while (rest > 0)
+        {
+            uint32_t seg = (rest > 2 * 32767) ? 2 * 32767 : rest;
+            if (rest - seg == 1)
+                seg--;
+            out[n].level0 = 0; out[n].duration0 = seg / 2;
+            out[n].level1 = 0; out[n].duration1 = seg - seg / 2;
+            n++;
+            rest -= seg;
+        }
+        return n;
+    }
+
+    // Generate the next chunk: roughly RMT_CHUNK_MS worth of pulses, bounded
+    // by the buffer size. Returns the number of symbols written.
+    size_t fillChunk(rmt_symbol_word_t *buf, uint32_t &pulses)
+    {
+        size_t used = 0;
+        uint32_t budget = 0;
+        pulses = 0;
+
+        while (true)
+        {
+            uint32_t hz;
+            if (moveMode)
+            {
+                if (moveDone >= moveTotal)
+                    break;
+                hz = movePulseHz();
+            }
+            else
+            {
+                hz = contHz;
+            }
+            if (hz == 0)
+                break;
+
+            if (budget == 0)
+            {
+                budget = (uint32_t)(((uint64_t)hz * RMT_CHUNK_MS) / 1000);
+                if (budget == 0) budget = 1;
+            }
+            if (pulses >= budget)
+                break;
+
+            uint32_t acc = phaseAcc + RMT_PULSE_RES_HZ;
+            uint32_t period = acc / hz;
+            size_t need = symbolsFor(period);
+            if (used + need > RMT_CHUNK_SYMBOLS)
+                break;
+
+            phaseAcc = acc - period * hz;
+            used += encodePulse(buf + used, period);
+            pulses++;
+            lastHz = hz;
+            if (moveMode)
+                moveDone++;
+        }
+        return used;
+    }
+
+    // Pulses of chunk 'slot' whose rising edge lies within 'elapsedUs' of
+    // the chunk's start.
+    uint32_t pulsesStarted(uint8_t slot, int64_t elapsedUs) const
+    {
+        uint32_t n = 0;
+        uint64_t tick = 0;
+        for (uint16_t i = 0; i < chunkSymbols[slot]; i++)
+        {
+            const rmt_symbol_word_t &s = buffers[slot][i];
+            if ((int64_t)(tick * 1000000 / RMT_PULSE_RES_HZ) >= elapsedUs)
+                break;
+            if (s.level0)
+                n++;
+            tick += s.duration0 + s.duration1;
+        }
+        return n;
+    }
+
+    // TX-done callback (ISR): chunks complete in submission order, and the
+    // next queued one starts right away.
+    static bool IRAM_ATTR onDone(rmt_channel_handle_t, const rmt_tx_done_event_data_t *, void *ctx)
+    {
+        RmtPulseEngine *self = (RmtPulseEngine *)ctx;
+        portENTER_CRITICAL_ISR(&self->mux);
+        self->emitted += self->chunkPulses[self->tail % RMT_CHUNK_COUNT];
+        self->tail++;
+        self->chunkStartUs = esp_timer_get_time();
+        portEXIT_CRITICAL_ISR(&self->mux);
+        return false;
+    }
+
+    rmt_channel_handle_t chan    = nullptr;
+    rmt_encoder_handle_t encoder = nullptr;
+    mutable portMUX_TYPE mux     = portMUX_INITIALIZER_UNLOCKED;
+
+    // Chunk ring: 'head' counts submitted chunks (service), 'tail' completed (ISR).
+    rmt_symbol_word_t  buffers[RMT_CHUNK_COUNT][RMT_CHUNK_SYMBOLS];
+    uint32_t           chunkPulses[RMT_CHUNK_COUNT] = {0};
+    uint16_t           chunkSymbols[RMT_CHUNK_COUNT] = {0};
+    volatile uint32_t  head = 0, tail = 0;
+    volatile uint64_t  emitted = 0;
+    volatile int64_t   chunkStartUs = 0;   // When the chunk at 'tail' started
+
+    // Generator state.
+    uint32_t phaseAcc = 0;   // Sub-tick remainder carried between pulses
+    uint32_t contHz   = 0;   // Continuous-mode frequency
+    uint32_t lastHz   = 0;   // Frequency of the last generated pulse
+    bool     moveMode = false;
+    uint32_t moveTotal = 0, moveDone = 0;
+    uint32_t movePeak = 0, moveStart = 0, moveAccel = 0, moveDecel = 0;
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include <Arduino.h>
+
+// ================================ SCurveRamp ================================
+// Jerk-limited speed planner for the CLOCK frequency. Acceleration is not
+// switched on and off in one step as with a fixed Hz increment; it rises
+// and falls at a bounded jerk, so the Hz trajectory is an S-curve:
+//
+//   jerk +J -> accel at A (optional cruise) -> jerk -J -> target reached
+//
+// Each step takes the largest acceleration (raised by J*dt, held, or
+// lowered by J*dt) that still leaves room to ramp it back to zero, in
+// whole steps, before the target. So the planner arrives with zero
+// acceleration, never overshoots and never exceeds the jerk limit, and
+// for a fixed target the trajectory is monotonic.
+//
+// All math is integer: frequency and acceleration are Q8 fixed point
+// (1/256 Hz, 1/256 Hz/s) in int64, time steps are in microseconds.
+class SCurveRamp
+{
+public:
+    // Acceleration limits (Hz/s) for speeding up and slowing down, and the
+    // jerk limit (Hz/s^2). A jerk of 0 means "no jerk limit" (plain
+    // trapezoid at the acceleration limit).
+    void configure(uint32_t accelHzS, uint32_t decelHzS, uint32_t jerkHzS2)
+    {
+        aUp   = (int64_t)accelHzS << 8;
+        aDown = (int64_t)decelHzS << 8;
+        jerk  = jerkHzS2;
+    }
+
+    // Jump to 'hz' with zero acceleration (e.g. start from standstill).
+    void reset(uint32_t hz)
+    {
+        v = (int64_t)hz << 8;
+        a = 0;
+        rem = 0;
+    }
+
+    // Move to 'hz' keeping the acceleration (crossing a skip band).
+    void jump(uint32_t hz) { v = (int64_t)hz << 8; }
+
+    // Advance the trajectory by 'dtUs' toward 'targetHz'. Returns the new Hz.
+    // 'dtUs' is the real time since the previous step and need not be
+    // regular: uneven steps reach the target at the same time, give or take
+    // a few steps. The brake is planned as if the next steps were as long
+    // as this one, so with uneven steps it may land with a few steps' worth
+    // of acceleration left.
+    uint32_t step(uint32_t targetHz, uint32_t dtUs)
+    {
+        const int64_t target = (int64_t)targetHz << 8;
+        int64_t e = target - v;
+
+        if (e == 0)
+        {
+            a = 0;
+            rem = 0;
+            return hz();
+        }
+
+        const int64_t dir = (e > 0) ? 1 : -1;
+        const int64_t aMax = (dir > 0) ? aUp : aDown;  // Speeding up or slowing down
+        int64_t ad = a * dir;   // acceleration measured toward the target
+        int64_t ed = e * dir;   // remaining distance (> 0)
+
+        // Acceleration change allowed in this step (Q8 Hz/s).
+        int64_t da = ((int64_t)jerk * dtUs << 8) / 1000000;
+        if (da == 0) da = 1;
+
+        if (jerk == 0)
+        {
+            ad = aMax;
+        }
+        else
+        {
+            if (ad < 0)
+            {
+                ad += da;           // Target moved behind us: unwind first
+                if (ad > 0) ad = 0;
+            }
+            else
+            {
+                int64_t next = ad + da;                // Build up acceleration
+                if (next > aMax) next = aMax;
+                const int64_t rd = rem * dir;
+                if (!roomToStop(next, ed, dtUs, da, rd))
+                {
+                    next = ad;                         // Hold it
+                    if (!roomToStop(next, ed, dtUs, da, rd))
+                        next = (ad > da) ? ad - da : 0; // Round off the top of the S
+                }
+                ad = next;
+            }
+        }
+
+        a = ad * dir;
+        // Carry the sub-Q8 remainder: truncating it every step would lose
+        // up to 1/256 Hz per step whenever a*dt is not a whole Q8 unit.
+        int64_t num = a * (int64_t)dtUs + rem;
+        int64_t dv = num / 1000000;
+        rem = num % 1000000;
+
+        // Never pass the target: land on it. What acceleration is left is
+        // dropped by the next step.
+        if ((dv * dir) >= ed || (jerk && ad <= da && ed <= brakeFloor(dtUs)))
+        {
+            v = target;
+            rem = 0;
+        }
+        else
+        {
+            v += dv;
+        }
+        return hz();
+    }
+
+    // Current planned frequency, rounded to Hz.
+    uint32_t hz() const { return v <= 0 ? 0 : (uint32_t)((v + 128) >> 8); }
+
+    // Current planned acceleration (Hz/s, signed).
+    int32_t accelHzS() const { return (int32_t)(a >> 8); }
+
+    // True when sitting on 'targetHz' with no acceleration left.
+    bool settled(uint32_t targetHz) const
+    {
+        return a == 0 && v == ((int64_t)targetHz << 8);
+    }
+
+private:
+    // Whether a step at acceleration 'x' followed by steps ramping it down
+    // by 'da' to zero (the brake) stays within 'ed' (Q8 Hz), counting the
+    // integration remainder 'rd' carried in. Steps are assumed to stay
+    // 'dtUs' long.
+    static bool roomToStop(int64_t x, int64_t ed, uint32_t dtUs, int64_t da, int64_t rd)
+    {
+        int64_t n = x / da;                                   // Brake steps
+        int64_t sum = x + n * x - da * n * (n + 1) / 2;       // Q8 Hz/s x steps
+        int64_t dist = sum / 1000000 * dtUs + (sum % 1000000 * dtUs + rd) / 1000000;
+        return dist <= ed;
+    }
+
+    // Distance below which an approach with at most one step of jerk left
+    // snaps to target, so rounding or a brake that ended early never leaves
+    // the planner creeping: J*dt^2, and at least one Hz (the clock is set
+    // in whole Hz anyway).
+    int64_t brakeFloor(uint32_t dtUs) const
+    {
+        int64_t f = (((int64_t)jerk * dtUs << 8) / 1000000) * dtUs / 1000000 + 1;
+        return f > 256 ? f : 256;
+    }
+
+    int64_t  v     = 0;   // Frequency, Q8 Hz
+    int64_t  a     = 0;   // Acceleration, Q8 Hz/s
+    int64_t  rem   = 0;   // Integration remainder, Q8 Hz * 1e-6
+    int64_t  aUp   = 0;   // Acceleration limit while speeding up, Q8 Hz/s
+    int64_t  aDown = 0;   // Acceleration limit while slowing down, Q8 Hz/s
+    uint32_t jerk  = 0;   // Jerk limit, Hz/s^2
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Filter stages; a profile enables any combination (bit mask). They always
+// run in this order: spikes are removed before they can skew the average.
+enum RpmFilterStage : uint8_t
+{
+    RPM_FILT_MEDIAN = 1 << 0,   // Median of the last N samples (spike rejection)
+    RPM_FILT_AVG    = 1 << 1,   // Moving average of the last N samples
+    RPM_FILT_IIR    = 1 << 2    // First-order low-pass: y += alpha/256 * (x - y)
+};
+
+// ================================ RpmFilter =================================
+// Fixed-point filter chain between the raw RPM estimate and the published
+// value (both in tenths of RPM). All state lives in fixed arrays of
+// RPM_FILT_MAX_N entries: nothing is allocated, and the cost per sample is
+// bounded by one insertion sort of at most RPM_FILT_MAX_N values.
+//
+// The median and the moving average start with whatever history they have
+// (1..N samples), so there is no initial dip; the IIR starts on the first
+// sample.
+class RpmFilter
+{
+public:
+    // 'stages' is a RpmFilterStage mask. Window lengths are clamped to
+    // 1..RPM_FILT_MAX_N, alpha to 1..255 (weight of a new sample, /256).
+    void configure(uint8_t stages, uint8_t medianN, uint8_t avgN, uint8_t iirAlpha)
+    {
+        mask   = stages;
+        medLen = clampN(medianN);
+        avgLen = clampN(avgN);
+        alpha  = iirAlpha ? iirAlpha : 1;
+        reset();
+    }
+
+    // Forget the history; the next sample starts every stage afresh.
+    void reset()
+    {
+        medCount = medHead = 0;
+        avgCount = avgHead = 0;
+        avgSum   = 0;
+        iirPrimed = false;
+    }
+
+    bool active() const { return mask != 0; }
+
+    // Run one raw sample through the enabled stages.
+    uint32_t update(uint32_t x)
+    {
+        if (mask & RPM_FILT_MEDIAN) x = median(x);
+        if (mask & RPM_FILT_AVG)    x = average(x);
+        if (mask & RPM_FILT_IIR)    x = lowPass(x);
+        return x;
+    }
+
+private:
+    static uint8_t clampN(uint8_t n)
+    {
+        return n < 1 ? 1 : (n > RPM_FILT_MAX_N ? RPM_FILT_MAX_N : n);
+    }
+
+    uint32_t median(uint32_t x)
+    {
+        medBuf[medHead] = x;
+        medHead = (medHead + 1) % medLen;
+        if (medCount < medLen) medCount++;
+
+        // Insertion sort of a copy (N is small).
+        uint32_t s[RPM_FILT_MAX_N];
+        for (uint8_t i = 0; i < medCount; i++)
+        {
+            uint32_t v = medBuf[i];
+            int8_t j = i - 1;
+            while (j >= 0 && s[j] > v)
+            {
+                s[j + 1] = s[j];
+                j--;
+            }
+            s[j + 1] = v;
+        }
+        return s[medCount / 2];
+    }
+
+    uint32_t average(uint32_t x)
+    {
+        if (avgCount == avgLen)
+            avgSum -= avgBuf[avgHead];
+        else
+            avgCount++;
+        avgBuf[avgHead] = x;
+        avgSum += x;
+        avgHead = (avgHead + 1) % avgLen;
+        return (uint32_t)((avgSum + avgCount / 2) / avgCount);
+    }
+
+    uint32_t lowPass(uint32_t x)
+    {
+        int64_t xq = (int64_t)x << 8;   // Q8
+        if (!iirPrimed)
+        {
+            y = xq;
+            iirPrimed = true;
+        }
+        else
+        {
+            y += (xq - y) * alpha / 256;
+        }
+        return (uint32_t)((y + 128) >> 8);
+    }
+
+    uint8_t  mask  = 0;
+    uint8_t  medLen = 1, avgLen = 1;
+    uint16_t alpha = 256;
+
+    uint32_t medBuf[RPM_FILT_MAX_N];
+    uint8_t  medCount = 0, medHead = 0;
+
+    uint32_t avgBuf[RPM_FILT_MAX_N];
+    uint8_t  avgCount = 0, avgHead = 0;
+    uint64_t avgSum = 0;
+
+    int64_t  y = 0;                  // IIR state, Q8 tenths of RPM
+    bool     iirPrimed = false;
+};
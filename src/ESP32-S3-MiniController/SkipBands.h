@@ -0,0 +1,234 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "Sweep.h"
+
+// A clock range the motor resonates in. Unused when hiHz <= loHz.
+struct SkipBand
+{
+    uint32_t loHz;
+    uint32_t hiHz;
+};
+
+// ================================ Skip bands ================================
+// Each profile holds up to SKIP_MAX_BANDS disjoint bands, sorted by loHz.
+// The edges themselves are outside a band, so a target moved onto an edge
+// is never moved again. Helpers are free functions over the profile array.
+
+inline bool skipBandUsed(const SkipBand &b) { return b.hiHz > b.loHz; }
+
+inline uint8_t skipBandCount(const SkipBand *b)
+{
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < SKIP_MAX_BANDS; i++)
+        if (skipBandUsed(b[i]))
+            n++;
+    return n;
+}
+
+inline void skipBandsClear(SkipBand *b)
+{
+    for (uint8_t i = 0; i < SKIP_MAX_BANDS; i++)
+        b[i] = {0, 0};
+}
+
+// A setpoint inside a band goes to its upper edge (dir > 0), its lower
+// edge (dir < 0) or the nearer one (dir == 0).
+inline uint32_t skipBandAdjust(const SkipBand *b, uint32_t hz, int dir)
+{
+    for (uint8_t i = 0; i < SKIP_MAX_BANDS; i++)
+    {
+        if (!skipBandUsed(b[i]) || hz <= b[i].loHz || hz >= b[i].hiHz)
+            continue;
+        if (dir == 0)
+            dir = (hz - b[i].loHz <= b[i].hiHz - hz) ? -1 : 1;
+        return dir > 0 ? b[i].hiHz : b[i].loHz;
+    }
+    return hz;
+}
+
+// Ramp position 'hz' inside a band that 'target' is outside of: the edge
+// toward the target, so the band is crossed in one step. Otherwise 'hz'.
+inline uint32_t skipBandExit(const SkipBand *b, uint32_t hz, uint32_t target)
+{
+    for (uint8_t i = 0; i < SKIP_MAX_BANDS; i++)
+    {
+        if (!skipBandUsed(b[i]) || hz <= b[i].loHz || hz >= b[i].hiHz)
+            continue;
+        if (target > b[i].loHz && target < b[i].hiHz)
+            return hz;
+        return target > hz ? b[i].hiHz : b[i].loHz;
+    }
+    return hz;
+}
+
+// Add [lo, hi], merged with the bands it overlaps. Returns false (bands
+// unchanged) if it overlaps none and all slots are taken.
+inline bool skipBandAdd(SkipBand *b, uint32_t lo, uint32_t hi)
+{
+    if (hi <= lo)
+        return false;
+
+    SkipBand keep[SKIP_MAX_BANDS];
+    uint8_t n = 0;
+    bool grown = true;
+    bool taken[SKIP_MAX_BANDS] = {};
+    while (grown)   // A merge can widen the band onto a neighbour
+    {
+        grown = false;
+        for (uint8_t i = 0; i < SKIP_MAX_BANDS; i++)
+        {
+            if (taken[i] || !skipBandUsed(b[i]) || lo > b[i].hiHz || hi < b[i].loHz)
+                continue;
+            if (b[i].loHz < lo) lo = b[i].loHz;
+            if (b[i].hiHz > hi) hi = b[i].hiHz;
+            taken[i] = true;
+            grown = true;
+        }
+    }
+    for (uint8_t i = 0; i < SKIP_MAX_BANDS; i++)
+        if (!taken[i] && skipBandUsed(b[i]))
+            keep[n++] = b[i];
+    if (n >= SKIP_MAX_BANDS)
+        return false;
+
+    // Insert in order.
+    uint8_t at = n;
+    while (at > 0 && keep[at - 1].loHz > lo)
+    {
+        keep[at] = keep[at - 1];
+        at--;
+    }
+    keep[at] = {lo, hi};
+    n++;
+
+    skipBandsClear(b);
+    for (uint8_t i = 0; i < n; i++)
+        b[i] = keep[i];
+    return true;
+}
+
+// Resonance bands of a sweep curve. A step is resonant when its ripple,
+// as a share of its speed, is at least SKIP_RIPPLE_PCT % and at least
+// SKIP_RIPPLE_X times the median over the curve (so a curve that is noisy
+// throughout flags nothing). Neighbouring resonant steps form one band,
+// reaching halfway to the steps on either side. The pull-out step and
+// those past it are ignored. When there are more than SKIP_MAX_BANDS, the
+// strongest are kept. Returns the number of bands written to 'out'.
+inline uint8_t skipBandsFromCurve(const SweepCurve &c, SkipBand *out)
+{
+    skipBandsClear(out);
+    uint8_t n = c.pullOut < c.count ? c.pullOut : c.count;
+    if (n < 3)
+        return 0;
+
+    // Ripple per step (% of speed, x10) and its median.
+    uint32_t pct[SWEEP_POINTS], sorted[SWEEP_POINTS];
+    for (uint8_t i = 0; i < n; i++)
+    {
+        pct[i] = c.pt[i].rpm ? (uint32_t)c.pt[i].rippleX10 * 100 / c.pt[i].rpm : 0;
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > pct[i])
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = pct[i];
+    }
+    uint32_t median = sorted[n / 2];
+    uint32_t floor  = (uint32_t)SKIP_RIPPLE_PCT * 10;
+    if (median * SKIP_RIPPLE_X > floor)
+        floor = median * SKIP_RIPPLE_X;
+
+    SkipBand cand[SWEEP_POINTS];
+    uint32_t peak[SWEEP_POINTS];
+    uint8_t  k = 0;
+    for (uint8_t i = 0; i < n; )
+    {
+        if (pct[i] < floor || c.pt[i].rpm == 0)
+        {
+            i++;
+            continue;
+        }
+        uint8_t j = i;
+        uint32_t p = pct[i];
+        while (j + 1 < n && pct[j + 1] >= floor && c.pt[j + 1].rpm != 0)
+        {
+            j++;
+            if (pct[j] > p) p = pct[j];
+        }
+        // Half a step past the ends; the first may not reach below 0 Hz.
+        uint32_t lo, hi;
+        if (i > 0)
+            lo = (c.pt[i - 1].hz + c.pt[i].hz) / 2;
+        else
+        {
+            uint32_t d = c.pt[1].hz - c.pt[0].hz;
+            lo = (d / 2 > c.pt[0].hz) ? 0 : c.pt[0].hz - d / 2;
+        }
+        if (j + 1 < n)
+            hi = (c.pt[j].hz + c.pt[j + 1].hz) / 2;
+        else
+            hi = j > 0 ? c.pt[j].hz + (c.pt[j].hz - c.pt[j - 1].hz) / 2 : c.pt[j].hz;
+        cand[k]   = {lo, hi};
+        peak[k++] = p;
+        i = j + 1;
+    }
+
+    // Drop the weakest until they fit; the rest stay in Hz order.
+    while (k > SKIP_MAX_BANDS)
+    {
+        uint8_t w = 0;
+        for (uint8_t i = 1; i < k; i++)
+            if (peak[i] < peak[w])
+                w = i;
+        for (uint8_t i = w; i + 1 < k; i++)
+        {
+            cand[i] = cand[i + 1];
+            peak[i] = peak[i + 1];
+        }
+        k--;
+    }
+    for (uint8_t i = 0; i < k; i++)
+        out[i] = cand[i];
+    return k;
+}
+
+// ============================== ResonanceWatch ==============================
+// Live detection from the FG period spread (longest minus shortest
+// edge-to-edge interval of an RPM window, as a % of the mean interval).
+// A spread of at least SKIP_LIVE_SPREAD_PCT, held for SKIP_LIVE_MS at a
+// steady clock that stays within SKIP_LIVE_BAND_PCT % of where it began,
+// reports a resonance at that clock. Any other window restarts the count.
+class ResonanceWatch
+{
+public:
+    void reset() { spanMs = 0; }
+
+    // Returns true once per detection; hz() is the clock it was found at.
+    bool update(uint32_t hz, uint32_t spreadPct, uint32_t windowMs, bool steady)
+    {
+        if (!steady || hz == 0 || spreadPct < SKIP_LIVE_SPREAD_PCT)
+        {
+            spanMs = 0;
+            return false;
+        }
+        uint32_t d = hz > refHz ? hz - refHz : refHz - hz;
+        if (spanMs == 0 || (uint64_t)d * 100 > (uint64_t)refHz * SKIP_LIVE_BAND_PCT)
+        {
+            refHz  = hz;
+            spanMs = 0;
+        }
+        spanMs += windowMs;
+        if (spanMs < SKIP_LIVE_MS)
+            return false;
+        spanMs = 0;
+        return true;
+    }
+
+    uint32_t hz() const { return refHz; }
+
+private:
+    uint32_t refHz = 0;    // Clock the current run started at
+    uint32_t spanMs = 0;   // Time with a high spread so far
+};
@@ -0,0 +1,154 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Slip tiers, in escalating order.
+enum SlipLevel : uint8_t
+{
+    SLIP_OK     = 0,
+    SLIP_WARN   = 1,   // Shown on the UI only
+    SLIP_DERATE = 2,   // Loop opened and clock cut back
+    SLIP_STALL  = 3    // Motor stopped; latched until the next start
+};
+
+// =============================== SlipMonitor ================================
+// Compares the measured speed with the speed the clock should produce:
+//
+//   expected rpmX10 = clock Hz * ratio,   ratio = 600 / clock pulses per rev
+//   slip %          = 100 * (expected - measured) / expected
+//
+// The ratio is Q16 (tenths of RPM per Hz). It comes from the profile, or,
+// when the profile leaves it at 0, is learned from SLIP_LEARN_MS of steady,
+// full-confidence running after a start (the motor is assumed healthy then).
+//
+// A tier is entered after SLIP_TRIP_SAMPLES consecutive samples above its
+// threshold (the lowest tier seen in the streak wins) and left once the slip
+// falls SLIP_HYST_PCT below it. SLIP_STALL stays until rearm(). Nothing is
+// checked for SLIP_GRACE_MS after a start or below SLIP_MIN_RPM expected.
+// The class only sees samples; MotorRuntime acts on the level changes.
+class SlipMonitor
+{
+public:
+    // 'clockPerRev' = 0 learns the ratio.
+    void configure(uint32_t clockPerRev)
+    {
+        ratio    = clockPerRev ? (600UL << 16) / clockPerRev : 0;
+        learning = (clockPerRev == 0);
+        rearm(0);
+    }
+
+    // A new run: clear the tier and restart the grace time.
+    void rearm(uint32_t nowMs)
+    {
+        lvl       = SLIP_OK;
+        pct       = 0;
+        expX10    = 0;
+        streak    = 0;
+        graceMs   = nowMs;
+        learnN    = 0;
+    }
+
+    // Feed one RPM sample. 'hz' is the mean clock over the sample window,
+    // 'windowMs' its length; 'steady' is false while the clock ramps and
+    // 'confident' false for partial or bounded readings.
+    SlipLevel update(uint32_t hz, uint32_t rpmX10, uint32_t windowMs, uint32_t nowMs,
+                     bool steady, bool confident)
+    {
+        if (nowMs - graceMs < SLIP_GRACE_MS)
+            return lvl;
+
+        if (ratio == 0)
+        {
+            learn(hz, rpmX10, windowMs, steady && confident);
+            return lvl;
+        }
+
+        expX10 = (uint32_t)(((uint64_t)hz * ratio) >> 16);
+        if (expX10 < SLIP_MIN_RPM * 10)
+        {
+            pct    = 0;
+            streak = 0;
+            return lvl;
+        }
+        pct = (int32_t)(((int64_t)expX10 - rpmX10) * 100 / expX10);
+
+        SlipLevel want = pct >= SLIP_STOP_PCT   ? SLIP_STALL
+                       : pct >= SLIP_DERATE_PCT ? SLIP_DERATE
+                       : pct >= SLIP_WARN_PCT   ? SLIP_WARN : SLIP_OK;
+
+        if (want > lvl)
+        {
+            // Escalate after a streak; the window of its first sample
+            // marks the start of the detection latency.
+            if (streak == 0 || want < pendLvl)
+                pendLvl = want;
+            if (streak == 0)
+                firstMs = nowMs - windowMs;
+            if (++streak >= SLIP_TRIP_SAMPLES)
+            {
+                lvl       = pendLvl;
+                latencyMs = nowMs - firstMs;
+                streak    = 0;
+            }
+            return lvl;
+        }
+
+        streak = 0;
+        while (lvl != SLIP_OK && lvl != SLIP_STALL && pct < threshold(lvl) - SLIP_HYST_PCT)
+            lvl = (SlipLevel)(lvl - 1);
+        return lvl;
+    }
+
+    SlipLevel level() const { return lvl; }
+    bool     armed() const { return ratio != 0; }
+    bool     learned() const { return learning && ratio != 0; }
+    int32_t  slipPct() const { return pct; }
+    uint32_t expectedRpmX10() const { return expX10; }
+    uint32_t ratioQ16() const { return ratio; }
+
+    // From the start of the first over-threshold window to the last trip.
+    uint32_t tripLatencyMs() const { return latencyMs; }
+
+private:
+    static int32_t threshold(SlipLevel l)
+    {
+        return l == SLIP_STALL  ? SLIP_STOP_PCT
+             : l == SLIP_DERATE ? SLIP_DERATE_PCT : SLIP_WARN_PCT;
+    }
+
+    void learn(uint32_t hz, uint32_t rpmX10, uint32_t windowMs, bool usable)
+    {
+        if (!usable || hz == 0 || rpmX10 == 0)
+        {
+            learnN = 0;
+            return;
+        }
+        if (learnN == 0)
+        {
+            sumHz  = 0;
+            sumRpm = 0;
+            spanMs = 0;
+        }
+        learnN++;
+        sumHz  += hz;
+        sumRpm += rpmX10;
+        spanMs += windowMs;
+        if (spanMs >= SLIP_LEARN_MS)
+            ratio = (uint32_t)((sumRpm << 16) / sumHz);
+    }
+
+    uint32_t  ratio = 0;          // Q16 tenths of RPM per clock Hz (0: unknown)
+    bool      learning = false;   // Ratio learned at run time, not configured
+    SlipLevel lvl = SLIP_OK;
+    SlipLevel pendLvl = SLIP_OK;  // Lowest tier wanted during the streak
+    uint8_t   streak = 0;         // Consecutive samples above the current tier
+    int32_t   pct = 0;            // Last slip (%), negative when faster
+    uint32_t  expX10 = 0;         // Last expected speed (tenths of RPM)
+    uint32_t  graceMs = 0;        // Start of the grace time
+    uint32_t  firstMs = 0;        // Window start of the first sample of the streak
+    uint32_t  latencyMs = 0;
+
+    uint32_t  learnN = 0;         // Samples in the current learning run
+    uint64_t  sumHz = 0, sumRpm = 0;
+    uint32_t  spanMs = 0;
+};
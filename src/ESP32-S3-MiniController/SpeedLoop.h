@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+
+// ================================ SpeedPI ==================================
+// Fixed-point PI controller for closed-loop speed: the error is in RPM, the
+// output is the CLOCK frequency to command (Hz). Gains are integers in
+// milli-units so they can be stored per profile without floats:
+//
+//   kpMilli : Hz per RPM of error        (x1000)
+//   kiMilli : Hz per RPM of error per s  (x1000)
+//
+// The integrator holds the output baseline in mHz, so engaging the loop at
+// the current frequency is bumpless (reset(hz)). Anti-windup: the output is
+// clamped to [minHz, maxHz], the integrator is kept inside the same range,
+// and an integration step only goes as far as the output reaching the
+// clamp, never past it.
+class SpeedPI
+{
+public:
+    void configure(uint32_t kpMilli, uint32_t kiMilli)
+    {
+        kp = kpMilli;
+        ki = kiMilli;
+    }
+
+    // Restart from 'hz' with no accumulated error.
+    void reset(uint32_t hz) { integ = (int64_t)hz * 1000; }
+
+    // One controller update after 'dtMs' with 'errRpm' = target - measured.
+    // Returns the frequency to command (Hz).
+    uint32_t update(int32_t errRpm, uint32_t dtMs, uint32_t minHz, uint32_t maxHz)
+    {
+        const int64_t lo = (int64_t)minHz * 1000;
+        const int64_t hi = (int64_t)maxHz * 1000;
+
+        int64_t p     = (int64_t)kp * errRpm;                 // mHz
+        int64_t iStep = (int64_t)ki * errRpm * dtMs / 1000;   // mHz
+        int64_t u     = integ + iStep + p;
+
+        // Integrate up to the clamp; a saturated output stays where it is.
+        if (u > hi && iStep > 0)
+            iStep = (hi - p > integ) ? hi - p - integ : 0;
+        else if (u < lo && iStep < 0)
+            iStep = (lo - p < integ) ? lo - p - integ : 0;
+        integ += iStep;
+        if (integ < lo) integ = lo;
+        if (integ > hi) integ = hi;
+
+        u = integ + p;
+        if (u < lo) u = lo;
+        if (u > hi) u = hi;
+        return (uint32_t)((u + 500) / 1000);
+    }
+
+private:
+    int64_t  integ = 0;   // Integrator / output baseline, mHz
+    uint32_t kp = 0;      // Proportional gain, mHz per RPM
+    uint32_t ki = 0;      // Integral gain, mHz per RPM per s
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// ================================ SpscRing =================================
+// Lock-free single-producer / single-consumer ring buffer, used to hand FG
+// edge timestamps from the ISR to loop() without disabling interrupts.
+//
+//   producer (one context, e.g. an ISR) : push()
+//   consumer (one context, e.g. loop()) : pop(), clear()
+//
+// head and tail are free-running 32-bit counters; N is a power of two, so
+// 'index & (N - 1)' stays correct across their wrap. The producer publishes
+// an element with a release store of head after writing it; the consumer
+// frees a slot with a release store of tail after reading it. A full ring
+// never blocks: the new element is dropped and counted instead.
+template <typename T, uint32_t N>
+class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    // Producer: append 'v'. Returns false (and counts a drop) if full.
+    bool IRAM_ATTR push(const T &v)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N)
+        {
+            drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buf[h & (N - 1)] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: take the oldest element. Returns false if empty.
+    bool pop(T &v)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+        v = buf[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: discard everything queued so far.
+    void clear() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Elements queued (a snapshot; may grow right after on the producer side).
+    uint32_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    // Elements dropped because the ring was full, since boot (free running).
+    uint32_t dropped() const { return drops.load(std::memory_order_relaxed); }
+
+    static constexpr uint32_t capacity() { return N; }
+
+private:
+    T buf[N];
+    std::atomic<uint32_t> head{0};    // Next slot to write (producer)
+    std::atomic<uint32_t> tail{0};    // Next slot to read (consumer)
+    std::atomic<uint32_t> drops{0};   // Rejected pushes
+};
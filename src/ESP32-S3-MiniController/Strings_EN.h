@@ -27,10 +27,13 @@ struct Strings
     const char *menu;             // Main menu title
     const char *m_start;          // Start motor entry
     const char *m_stop;           // Stop motor entry
+    const char *m_estop;          // Emergency stop entry (while decelerating)
     const char *m_set_ccw;        // Force DIR = CCW action
     const char *m_set_cw;         // Force DIR = CW action
     const char *m_brake_on;       // Turn brake ON
     const char *m_brake_off;      // Turn brake OFF
+    const char *m_closed_on;      // Speed loop toggle, loop closed
+    const char *m_closed_off;     // Speed loop toggle, loop open
     const char *m_autotest;       // Run automatic test sequence
     const char *m_select_motor;   // Open motor selection list
     const char *m_add_motor;      // Start add-motor wizard
@@ -55,6 +58,21 @@ struct Strings
     const char *w_enable_active;  // Prompt: ENABLE polarity
     const char *w_ppr;            // Prompt: pulses per revolution
     const char *w_maxclk;         // Prompt: max clock (Hz)
+    const char *w_backend;        // Prompt: clock backend (LEDC/RMT)
+    const char *w_accel;          // Prompt: acceleration (Hz/s)
+    const char *w_decel;          // Prompt: deceleration (Hz/s)
+    const char *w_start_hz;       // Prompt: start frequency (Hz)
+    const char *w_stop_mode;      // Prompt: stop mode (cut/ramp/ramp+brake)
+    const char *w_stop_cut;       // Stop mode: cut
+    const char *w_stop_ramp;      // Stop mode: ramp
+    const char *w_stop_brake;     // Stop mode: ramp + brake
+    const char *w_kp;             // Prompt: speed loop Kp
+    const char *w_ki;             // Prompt: speed loop Ki
+    const char *w_clk_rev;        // Prompt: CLOCK pulses per revolution
+    const char *w_filter;         // Prompt: RPM filter stages
+    const char *w_median_n;       // Prompt: median window
+    const char *w_avg_n;          // Prompt: moving-average window
+    const char *w_iir_alpha;      // Prompt: IIR weight
     const char *w_save;           // Prompt: save profile?
     const char *yes;              // Choice: YES
     const char *no;               // Choice: NO
@@ -69,8 +87,9 @@ struct Strings
     const char *s_lang_en;        // Language option: English
     const char *s_lang_es;        // Language option: Spanish
     const char *s_telemetry;      // Telemetry label
-    const char *s_telemetry_on;   // Telemetry ON label
+    const char *s_telemetry_on;   // Telemetry text mode label
     const char *s_telemetry_off;  // Telemetry OFF label
+    const char *s_telemetry_bin;  // Telemetry binary mode label
 
     // ---------------- About -----------------------
     const char *about_title;      // About title
@@ -85,6 +104,29 @@ struct Strings
     // ---------------- Diagnostics -----------------
     const char *diag_title;       // Diagnostics title
     const char *diag_hint;        // Hint to exit diagnostics
+
+    // ---------------- Tuning screens --------------
+    const char *t_starting;       // Motor spinning up before the run
+    const char *t_done;           // Run finished, result saved
+    const char *t_cancel;         // Footer while running
+    const char *t_exit;           // Footer once finished
+    const char *at_menu;          // Menu item: relay autotune
+    const char *at_title;         // Autotune title
+    const char *at_settling;      // Autotune: waiting for a steady RPM
+    const char *at_cycle;         // Autotune: relay cycle counter label
+    const char *at_failed;        // Autotune: failed, gains unchanged
+    const char *t_step;           // Step counter label (calibration, sweep)
+    const char *t_failed;         // Failed, nothing stored (calibration, sweep)
+    const char *cal_menu;         // Menu item: FG calibration
+    const char *cal_title;        // FG calibration title
+    const char *sw_menu;          // Menu item: sweep curve
+    const char *sw_title;         // Sweep title
+    const char *sw_none;          // Sweep: no curve stored yet
+    const char *sw_new;           // Sweep footer: start a new sweep
+    const char *sw_steps;         // Sweep setup: step spacing label
+    const char *sw_linear;        // Sweep setup: linear spacing
+    const char *sw_range;         // Sweep setup: span of the steps
+    const char *sw_hint;          // Sweep setup footer
 };
 
 // English string table (read-only). Keep texts concise to fit 128x64 OLED.
@@ -110,10 +152,13 @@ static const Strings STR_EN = {
     "SETTINGS",                                      // menu
     "Start MOTOR",                                         // m_start
     "Stop MOTOR",                                          // m_stop
+    "EMERGENCY STOP",                                // m_estop
     "Set DIR = CCW",                                 // m_set_ccw
     "Set DIR = CW",                                  // m_set_cw
     "Brake ON",                                      // m_brake_on
     "Brake OFF",                                     // m_brake_off
+    "Closed loop: ON",                               // m_closed_on
+    "Closed loop: OFF",                              // m_closed_off
     "Auto Test",                                     // m_autotest
     "Select Motor",                                  // m_select_motor
     "Add Motor",                                     // m_add_motor
@@ -138,6 +183,21 @@ static const Strings STR_EN = {
     "ENABLE active:",                                // w_enable_active
     "PPR (pulses/rev)",                              // w_ppr
     "Max CLOCK (Hz)",                                // w_maxclk
+    "Pulse engine:",                                 // w_backend
+    "Accel (Hz/s)",                                  // w_accel
+    "Decel (Hz/s)",                                  // w_decel
+    "Start CLOCK (Hz)",                              // w_start_hz
+    "Stop mode:",                                    // w_stop_mode
+    "Cut",                                           // w_stop_cut
+    "Ramp",                                          // w_stop_ramp
+    "Ramp + brake",                                  // w_stop_brake
+    "Speed Kp (Hz/RPM)",                             // w_kp
+    "Speed Ki (Hz/RPM/s)",                           // w_ki
+    "Clock pulses/rev:",                             // w_clk_rev
+    "RPM filter:",                                   // w_filter
+    "Median window:",                                // w_median_n
+    "Average window:",                               // w_avg_n
+    "IIR weight (/256):",                            // w_iir_alpha
     "Save profile?",                                 // w_save
     "YES",                                           // yes
     "NO",                                            // no
@@ -152,8 +212,9 @@ static const Strings STR_EN = {
     "English",                                       // s_lang_en
     "Espanol",                                       // s_lang_es
     "Telemetry",                                     // s_telemetry
-    "Telemetry: ON",                                 // s_telemetry_on
+    "Telemetry: TEXT",                               // s_telemetry_on
     "Telemetry: OFF",                                // s_telemetry_off
+    "Telemetry: BINARY",                             // s_telemetry_bin
 
     // ---------------- About ----------------
     "ABOUT",                                         // about_title
@@ -167,5 +228,28 @@ static const Strings STR_EN = {
 
     // ---------------- Diagnostics ------------
     "DIAGNOSTICS",                                   // diag_title
-    "LEFT to exit"                                   // diag_hint
+    "LEFT to exit",                                  // diag_hint
+
+    // ---------------- Tuning screens ----------
+    "Starting motor...",                             // t_starting
+    "Done - saved",                                  // t_done
+    "LEFT to cancel",                                // t_cancel
+    "LEFT/RIGHT to exit",                            // t_exit
+    "Autotune PI",                                   // at_menu
+    "AUTOTUNE PI",                                   // at_title
+    "Settling...",                                   // at_settling
+    "Relay cycle",                                   // at_cycle
+    "Failed - gains kept",                           // at_failed
+    "Step",                                          // t_step
+    "Failed - no changes",                           // t_failed
+    "Calibrate FG",                                  // cal_menu
+    "FG CALIBRATION",                                // cal_title
+    "Sweep curve",                                   // sw_menu
+    "SWEEP CURVE",                                   // sw_title
+    "No curve stored",                               // sw_none
+    "RIGHT: new sweep",                              // sw_new
+    "Steps",                                         // sw_steps
+    "linear",                                        // sw_linear
+    "start Hz..max",                                 // sw_range
+    "UP/DN mode RIGHT run"                           // sw_hint
 };
@@ -27,10 +27,13 @@ static const Strings STR_ES = {
     "CONFIGURACION",                                 // menu
     "Arrancar MOTOR",                                // m_start
     "Parar MOTOR",                                   // m_stop
+    "PARO EMERGENCIA",                               // m_estop
     "DIR = CCW",                                     // m_set_ccw
     "DIR = CW",                                      // m_set_cw
     "Freno ON",                                      // m_brake_on
     "Freno OFF",                                     // m_brake_off
+    "Lazo cerrado: SI",                              // m_closed_on
+    "Lazo cerrado: NO",                              // m_closed_off
     "Auto Test",                                     // m_autotest
     "Seleccionar Motor",                             // m_select_motor
     "Anadir Motor",                                  // m_add_motor
@@ -55,6 +58,21 @@ static const Strings STR_ES = {
     "ENABLE activo:",                                // w_enable_active
     "PPR (pulsos/vuelta)",                           // w_ppr
     "CLOCK max (Hz)",                                // w_maxclk
+    "Generador pulsos:",                             // w_backend
+    "Acel. (Hz/s)",                                  // w_accel
+    "Decel. (Hz/s)",                                 // w_decel
+    "CLOCK inicial (Hz)",                            // w_start_hz
+    "Modo de parada:",                               // w_stop_mode
+    "Corte",                                         // w_stop_cut
+    "Rampa",                                         // w_stop_ramp
+    "Rampa + freno",                                 // w_stop_brake
+    "Kp vel. (Hz/RPM)",                              // w_kp
+    "Ki vel. (Hz/RPM/s)",                            // w_ki
+    "Pulsos reloj/vuelta:",                          // w_clk_rev
+    "Filtro RPM:",                                   // w_filter
+    "Ventana mediana:",                              // w_median_n
+    "Ventana media:",                                // w_avg_n
+    "Peso IIR (/256):",                              // w_iir_alpha
     "Guardar perfil?",                               // w_save
     "SI",                                            // yes
     "NO",                                            // no
@@ -69,8 +87,9 @@ static const Strings STR_ES = {
     "English",                                       // s_lang_en
     "Espanol",                                       // s_lang_es
     "Telemetria",                                    // s_telemetry
-    "Telemetria: ON",                                // s_telemetry_on
+    "Telemetria: TEXTO",                             // s_telemetry_on
     "Telemetria: OFF",                               // s_telemetry_off
+    "Telemetria: BINARIA",                           // s_telemetry_bin
 
     // ---------------- About ----------------
     "ACERCA DE",                                     // about_title
@@ -84,5 +103,28 @@ static const Strings STR_ES = {
 
     // ---------------- Diagnostics ----------------
     "DIAGNOSTICO",                                   // diag_title
-    "LEFT para salir"                                // diag_exit
+    "LEFT para salir",                               // diag_exit
+
+    // ---------------- Tuning screens ----------------
+    "Arrancando motor...",                           // t_starting
+    "Hecho - guardado",                              // t_done
+    "LEFT para cancelar",                            // t_cancel
+    "LEFT/RIGHT para salir",                         // t_exit
+    "Autoajuste PI",                                 // at_menu
+    "AUTOAJUSTE PI",                                 // at_title
+    "Estabilizando...",                              // at_settling
+    "Ciclo rele",                                    // at_cycle
+    "Fallo - sin cambios",                           // at_failed
+    "Paso",                                          // t_step
+    "Fallo - sin cambios",                           // t_failed
+    "Calibrar FG",                                   // cal_menu
+    "CALIBRACION FG",                                // cal_title
+    "Curva barrido",                                 // sw_menu
+    "CURVA BARRIDO",                                 // sw_title
+    "Sin curva guardada",                            // sw_none
+    "RIGHT: nuevo barrido",                          // sw_new
+    "Pasos",                                         // sw_steps
+    "lineal",                                        // sw_linear
+    "Hz inicio..max",                                // sw_range
+    "UP/DN modo RIGHT ir"                            // sw_hint
 };
@@ -0,0 +1,171 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>
+#include "Config.h"
+
+// One step of a frequency sweep.
+struct SweepPoint
+{
+    uint32_t hz;          // Mean clock over the measurement (Hz)
+    uint16_t rpm;         // Settled speed (mean of the raw readings)
+    uint16_t rippleX10;   // Peak-to-peak speed over the measurement (tenths of RPM)
+};
+
+// Hz-to-RPM curve of a profile, stored as one NVS blob (see ProfileStore).
+struct SweepCurve
+{
+    uint8_t    version;       // SWEEP_CURVE_VERSION; anything else is "no curve"
+    uint8_t    count;         // Valid points
+    uint8_t    logSpacing;    // 1: steps spaced logarithmically
+    uint8_t    pullOut;       // First point that lost the clock, or SWEEP_NONE
+    SweepPoint pt[SWEEP_POINTS];
+};
+
+static constexpr uint8_t SWEEP_CURVE_VERSION = 1;
+static constexpr uint8_t SWEEP_NONE = 0xFF;
+
+// ================================ FreqSweep =================================
+// Steps the clock from a start to a stop frequency in SWEEP_POINTS steps,
+// linear or logarithmic. At each step, once the ramp is done and
+// SWEEP_SETTLE_MS have passed, raw RPM readings are collected for
+// SWEEP_MEASURE_MS: their mean is the settled RPM, their spread the ripple.
+//
+// The first step fixes the RPM-per-Hz slope (or the caller passes a known
+// one). A step that falls more than SWEEP_PULLOUT_PCT below that line, or a
+// stall reported with stalled(), is the pull-out point: the sweep ends
+// there, since nothing above it would follow the clock either.
+// Like RelayAutotune, the class only sees samples and returns Hz.
+class FreqSweep
+{
+public:
+    enum State : uint8_t { SW_IDLE, SW_RUN, SW_DONE, SW_FAILED };
+
+    // 'ratioQ16': tenths of RPM per Hz, Q16 (0: take it from the first step).
+    void begin(uint32_t startHz, uint32_t stopHz, bool logSpacing, uint32_t ratioQ16, uint32_t nowMs)
+    {
+        if (stopHz < startHz)
+            stopHz = startHz;
+        for (uint8_t i = 0; i < SWEEP_POINTS; i++)
+        {
+            if (logSpacing && startHz > 0)
+                stepHz[i] = (uint32_t)lroundf(startHz * powf((float)stopHz / startHz,
+                                                             (float)i / (SWEEP_POINTS - 1)));
+            else
+                stepHz[i] = startHz + (uint32_t)((uint64_t)(stopHz - startHz) * i / (SWEEP_POINTS - 1));
+        }
+
+        crv = {};
+        crv.version    = SWEEP_CURVE_VERSION;
+        crv.logSpacing = logSpacing ? 1 : 0;
+        crv.pullOut    = SWEEP_NONE;
+        ratio   = ratioQ16;
+        startMs = nowMs;
+        st      = SW_RUN;
+        restartStep(nowMs);
+    }
+
+    void abort() { st = SW_FAILED; }
+
+    // The motor stalled (e.g. FG lost) at the current step: that step is
+    // the pull-out point and the points so far are the result.
+    void stalled()
+    {
+        if (st != SW_RUN)
+            return;
+        st = SW_DONE;
+        if (crv.count >= SWEEP_POINTS)
+            return;
+        SweepPoint &p = crv.pt[crv.count];
+        p.hz        = stepHz[crv.count];
+        p.rpm       = 0;
+        p.rippleX10 = 0;
+        crv.pullOut = crv.count++;
+    }
+
+    bool active() const { return st == SW_RUN; }
+
+    // Feed one raw RPM reading (tenths) and the mean clock over its window.
+    // Returns the clock frequency to command (Hz).
+    uint32_t update(uint32_t rpmX10, uint32_t hz, uint32_t windowMs, uint32_t nowMs, bool steady)
+    {
+        if (st != SW_RUN)
+            return 0;
+        if (nowMs - startMs > SWEEP_MAX_MS)
+        {
+            st = SW_FAILED;
+            return 0;
+        }
+
+        uint8_t i = crv.count;
+        if (!steady)
+        {
+            restartStep(nowMs);
+            return stepHz[i];
+        }
+        if (nowMs - stepMs < SWEEP_SETTLE_MS)
+            return stepHz[i];
+
+        rpmMs  += (uint64_t)rpmX10 * windowMs;
+        hzMs   += (uint64_t)hz * windowMs;
+        spanMs += windowMs;
+        if (rpmX10 < minX10) minX10 = rpmX10;
+        if (rpmX10 > maxX10) maxX10 = rpmX10;
+        if (spanMs < SWEEP_MEASURE_MS)
+            return stepHz[i];
+
+        // Step done.
+        SweepPoint &p = crv.pt[i];
+        uint32_t meanX10 = (uint32_t)(rpmMs / spanMs);
+        p.hz        = (uint32_t)(hzMs / spanMs);
+        p.rpm       = (uint16_t)((meanX10 + 5) / 10 > 0xFFFF ? 0xFFFF : (meanX10 + 5) / 10);
+        p.rippleX10 = (uint16_t)(maxX10 - minX10 > 0xFFFF ? 0xFFFF : maxX10 - minX10);
+        crv.count++;
+
+        if (ratio == 0 && i == 0 && p.hz > 0)
+            ratio = (uint32_t)(((uint64_t)meanX10 << 16) / p.hz);
+        uint32_t expX10 = (uint32_t)(((uint64_t)p.hz * ratio) >> 16);
+        if ((uint64_t)meanX10 * 100 < (uint64_t)expX10 * (100 - SWEEP_PULLOUT_PCT))
+        {
+            crv.pullOut = i;
+            st = SW_DONE;
+            return 0;
+        }
+
+        if (crv.count >= SWEEP_POINTS)
+        {
+            st = SW_DONE;
+            return 0;
+        }
+        restartStep(nowMs);
+        return stepHz[crv.count];
+    }
+
+    State   state() const { return st; }
+    uint8_t stepsDone() const { return crv.count; }
+    uint32_t currentStepHz() const { return stepHz[crv.count < SWEEP_POINTS ? crv.count : SWEEP_POINTS - 1]; }
+    uint32_t firstStepHz() const { return stepHz[0]; }
+
+    // Result (complete in SW_DONE).
+    const SweepCurve &curve() const { return crv; }
+
+private:
+    void restartStep(uint32_t nowMs)
+    {
+        stepMs = nowMs;
+        rpmMs  = 0;
+        hzMs   = 0;
+        spanMs = 0;
+        minX10 = UINT32_MAX;
+        maxX10 = 0;
+    }
+
+    State      st = SW_IDLE;
+    SweepCurve crv = {};
+    uint32_t   stepHz[SWEEP_POINTS] = {};
+    uint32_t   ratio = 0;           // Q16 tenths of RPM per Hz
+    uint32_t   startMs = 0;         // begin(): SWEEP_MAX_MS counts from here
+    uint32_t   stepMs = 0;          // When the clock settled on this step
+    uint64_t   rpmMs = 0, hzMs = 0; // Time-weighted sums over the measurement
+    uint32_t   spanMs = 0;
+    uint32_t   minX10 = UINT32_MAX, maxX10 = 0;
+};
@@ -0,0 +1,202 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ============================== TelemetryFrame ==============================
+// Wire format of the binary telemetry. Kept free of Arduino headers: the
+// host decoder (tools/telemetry_decode.cpp) includes this file as is, and
+// uses TelemetryDecoder below.
+//
+// Frame = COBS( record | CRC16 ) 0x00
+//
+//   record : TelemetryRecord, little-endian, packed (below)
+//   CRC16  : CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over the record,
+//            low byte first
+//   COBS   : Consistent Overhead Byte Stuffing, so the only 0x00 on the
+//            wire is the frame delimiter; a receiver resynchronizes on the
+//            next 0x00 after any error
+//
+// A layout change bumps TELEM_VERSION; the host decoder only takes records
+// of the version it was built with. 'size' carries the record length.
+
+static constexpr uint8_t TELEM_VERSION = 1;
+
+// TelemetryRecord::flags
+enum TelemetryFlag : uint16_t
+{
+    TF_RUNNING   = 1u << 0,   // Motor commanded to run
+    TF_STOPPING  = 1u << 1,   // Ramped stop in progress
+    TF_DIR_CW    = 1u << 2,   // Applied direction is CW
+    TF_RAMPING   = 1u << 3,   // Ramp still moving toward targetHz
+    TF_CLOSED    = 1u << 4,   // Closed-loop speed control on
+    TF_LD        = 1u << 5,   // LD input asserted
+    TF_LD_TRIP   = 1u << 6,   // LD trip latched (CLOCK gated)
+    TF_PERIOD    = 1u << 7,   // RPM from FG edge periods (else count)
+    TF_SLIP_MASK = 3u << 8,   // SlipLevel (0..3)
+    TF_FG_LOSS   = 1u << 10,  // FG loss cut the motor
+    TF_STALL     = 1u << 11,  // Start timeout or slip stall
+    TF_MOVE      = 1u << 12,  // Positioned move running
+    TF_TEST      = 1u << 13,  // Autotune, FG calibration or sweep running
+    TF_GAP       = 1u << 15,  // Records were dropped just before this one
+};
+static constexpr uint8_t TF_SLIP_SHIFT = 8;
+
+struct __attribute__((packed)) TelemetryRecord
+{
+    uint8_t  version;     // TELEM_VERSION
+    uint8_t  size;        // sizeof(TelemetryRecord) of the sender
+    uint16_t seq;         // Counts every record taken, sent or dropped
+    uint32_t timeUs;      // esp_timer time when taken (wraps after ~71 min)
+    uint32_t currentHz;   // CLOCK frequency being generated
+    uint32_t targetHz;    // Frequency the ramp is heading for
+    uint32_t rpmX10;      // Last RPM estimate (tenths, filtered)
+    uint16_t flags;       // TelemetryFlag bits
+};
+
+static constexpr size_t TELEM_PAYLOAD = sizeof(TelemetryRecord) + 2;          // + CRC16
+static constexpr size_t TELEM_FRAME_MAX = TELEM_PAYLOAD + TELEM_PAYLOAD / 254 + 2; // + COBS, 0x00
+
+inline uint16_t telemCrc16(const uint8_t *p, size_t n)
+{
+    uint16_t crc = 0xFFFF;
+    while (n--)
+    {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+// COBS-encode 'n' bytes into 'out' (room for n + n/254 + 1). Returns the
+// encoded length; no delimiter is added.
+inline size_t telemCobsEncode(const uint8_t *in, size_t n, uint8_t *out)
+{
+    size_t  code = 0;   // Where the current block's length byte goes
+    size_t  o = 1;
+    uint8_t len = 1;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[code] = len;
+            code = o++;
+            len = 1;
+            continue;
+        }
+        out[o++] = in[i];
+        if (++len == 0xFF)
+        {
+            out[code] = len;
+            code = o++;
+            len = 1;
+        }
+    }
+    out[code] = len;
+    return o;
+}
+
+// Decode one COBS block (delimiter stripped). Returns the decoded length,
+// or 0 if the block is malformed or does not fit 'cap'.
+inline size_t telemCobsDecode(const uint8_t *in, size_t n, uint8_t *out, size_t cap)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < n; )
+    {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > n)
+            return 0;
+        for (uint8_t k = 1; k < code; k++)
+        {
+            if (o >= cap)
+                return 0;
+            out[o++] = in[i++];
+        }
+        if (code != 0xFF && i < n)
+        {
+            if (o >= cap)
+                return 0;
+            out[o++] = 0;
+        }
+    }
+    return o;
+}
+
+// Build the full frame for 'r' into 'out' (TELEM_FRAME_MAX bytes).
+// Returns its length, delimiter included.
+inline size_t telemEncodeFrame(const TelemetryRecord &r, uint8_t *out)
+{
+    uint8_t raw[TELEM_PAYLOAD];
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(&r);
+    for (size_t i = 0; i < sizeof(r); i++)
+        raw[i] = p[i];
+    uint16_t crc = telemCrc16(raw, sizeof(r));
+    raw[sizeof(r)]     = (uint8_t)(crc & 0xFF);
+    raw[sizeof(r) + 1] = (uint8_t)(crc >> 8);
+    size_t n = telemCobsEncode(raw, sizeof(raw), out);
+    out[n++] = 0;
+    return n;
+}
+
+// ============================ TelemetryDecoder =============================
+// Receiving side (host only): checks one frame (delimiter stripped) and
+// tracks the sequence. A record must be of this TELEM_VERSION and hold at
+// least the fields known here. A sequence number ahead by less than half
+// its range counts the skipped records as missing; one that goes back (or
+// repeats) means the device restarted, and the time base starts over.
+// timeUs is unwrapped to 64 bits.
+struct TelemetryDecoder
+{
+    uint64_t good = 0, bad = 0, missing = 0, restarts = 0;
+    bool     haveLast = false;
+    uint16_t lastSeq = 0;
+    uint32_t lastUs = 0;
+    uint64_t highUs = 0;   // Added to timeUs: 2^32 per wrap
+
+    // Returns true and fills 'r' and 'timeUs' for a good record.
+    bool frame(const uint8_t *p, size_t n, TelemetryRecord &r, uint64_t &timeUs)
+    {
+        if (n == 0)
+            return false;
+        uint8_t raw[TELEM_PAYLOAD + 256];
+        size_t len = telemCobsDecode(p, n, raw, sizeof(raw));
+
+        // version, size, ..., CRC16
+        if (len < 4 || raw[0] != TELEM_VERSION || raw[1] < sizeof(TelemetryRecord) ||
+            len != (size_t)raw[1] + 2)
+        {
+            bad++;
+            return false;
+        }
+        uint16_t crc = (uint16_t)(raw[len - 2] | (raw[len - 1] << 8));
+        if (telemCrc16(raw, len - 2) != crc)
+        {
+            bad++;
+            return false;
+        }
+
+        memcpy(&r, raw, sizeof(r));
+        if (haveLast)
+        {
+            int16_t step = (int16_t)(uint16_t)(r.seq - lastSeq);
+            if (step <= 0)
+            {
+                restarts++;
+                highUs = 0;
+            }
+            else
+            {
+                missing += (uint16_t)(step - 1);
+                if (r.timeUs < lastUs)
+                    highUs += 1ULL << 32;
+            }
+        }
+        haveLast = true;
+        lastSeq = r.seq;
+        lastUs = r.timeUs;
+        good++;
+        timeUs = highUs + r.timeUs;
+        return true;
+    }
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <stdio.h>
+
+// ================================== Check ===================================
+// Assertions for the host tests. A failed check prints where and what and
+// the run goes on, so one pass shows every failure; checkExit() then gives
+// the exit code ctest looks at.
+namespace check
+{
+inline int failures = 0;
+inline int checks = 0;
+
+inline void fail(const char *file, int line, const char *what)
+{
+    printf("%s:%d: FAILED: %s\n", file, line, what);
+    failures++;
+}
+} // namespace check
+
+#define CHECK(cond)                                              \
+    do                                                           \
+    {                                                            \
+        check::checks++;                                         \
+        if (!(cond))                                             \
+            check::fail(__FILE__, __LINE__, #cond);              \
+    } while (0)
+
+// |a - b| <= tol, both sides printed on failure.
+#define CHECK_NEAR(a, b, tol)                                                     \
+    do                                                                            \
+    {                                                                             \
+        check::checks++;                                                          \
+        double va_ = (double)(a), vb_ = (double)(b);                              \
+        if (!(va_ - vb_ <= (tol) && vb_ - va_ <= (tol)))                          \
+        {                                                                         \
+            check::fail(__FILE__, __LINE__, #a " ~ " #b);                         \
+            printf("    %g vs %g (tolerance %g)\n", va_, vb_, (double)(tol));     \
+        }                                                                         \
+    } while (0)
+
+inline int checkExit(const char *name)
+{
+    printf("%s: %d checks, %d failed\n", name, check::checks, check::failures);
+    return check::failures ? 1 : 0;
+}
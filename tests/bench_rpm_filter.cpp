@@ -0,0 +1,63 @@
+// Time per RpmFilter::update() for each stage configuration, on noisy
+// input. Not a test (host timings say little about the ESP32-S3 in
+// absolute terms); it shows what each stage and window length costs
+// relative to the others, the median sort above all.
+//
+//   ./bench_rpm_filter [samples]
+#include "Config.h"
+#include "RpmFilter.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace
+{
+
+struct Case
+{
+    const char *name;
+    uint8_t stages, medianN, avgN, alpha;
+};
+
+const Case CASES[] = {
+    {"raw",                 0,                                              1,  1,  64},
+    {"median 5",            RPM_FILT_MEDIAN,                                5,  1,  64},
+    {"median 15",           RPM_FILT_MEDIAN,                                15, 1,  64},
+    {"average 4",           RPM_FILT_AVG,                                   1,  4,  64},
+    {"average 15",          RPM_FILT_AVG,                                   1,  15, 64},
+    {"iir 64",              RPM_FILT_IIR,                                   1,  1,  64},
+    {"median 5 + avg 4 + iir", RPM_FILT_MEDIAN | RPM_FILT_AVG | RPM_FILT_IIR, 5,  4,  64},
+    {"median 15 + avg 15 + iir", RPM_FILT_MEDIAN | RPM_FILT_AVG | RPM_FILT_IIR, 15, 15, 64},
+};
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 10000000;
+
+    // Input: 1500.0 RPM with +-2% noise and a dropout every 37 samples.
+    static uint32_t in[4096];
+    uint32_t rnd = 12345;
+    for (uint32_t i = 0; i < 4096; i++)
+    {
+        rnd = rnd * 1664525u + 1013904223u;
+        in[i] = i % 37 ? 15000 - 300 + (rnd >> 16) % 601 : 0;
+    }
+
+    printf("%-26s %10s\n", "stages", "ns/sample");
+    for (const Case &c : CASES)
+    {
+        RpmFilter f;
+        f.configure(c.stages, c.medianN, c.avgN, c.alpha);
+        volatile uint32_t sink = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < n; i++)
+            sink = f.update(in[i & 4095]);
+        auto t1 = std::chrono::steady_clock::now();
+        (void)sink;
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+        printf("%-26s %10.2f\n", c.name, ns);
+    }
+    return 0;
+}
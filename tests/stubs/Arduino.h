@@ -0,0 +1,78 @@
+#pragma once
+// Host stand-in for the Arduino-ESP32 core: just what the sketch headers
+// use. Time, pins and LEDC are simulated in HostSim.cpp (see HostSim.h).
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+
+#define IRAM_ATTR
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+inline int digitalPinToInterrupt(int pin) { return pin; }
+void attachInterrupt(int pin, void (*isr)(), int mode);
+void attachInterruptArg(int pin, void (*isr)(void *), void *arg, int mode);
+void detachInterrupt(int pin);
+
+bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t bits);
+bool ledcAttachChannel(uint8_t pin, uint32_t freq, uint8_t bits, int8_t channel);
+bool ledcWrite(uint8_t pin, uint32_t duty);
+bool ledcDetach(uint8_t pin);
+uint32_t ledcChangeFrequency(uint8_t pin, uint32_t freq, uint8_t bits);
+
+// Single-threaded host: critical sections have nothing to exclude.
+typedef struct { volatile uint32_t owner; uint32_t count; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+inline void portENTER_CRITICAL(portMUX_TYPE *) {}
+inline void portEXIT_CRITICAL(portMUX_TYPE *) {}
+inline void portENTER_CRITICAL_ISR(portMUX_TYPE *) {}
+inline void portEXIT_CRITICAL_ISR(portMUX_TYPE *) {}
+
+class String
+{
+public:
+    String(const char *s = "") : s_(s) {}
+    const char *c_str() const { return s_.c_str(); }
+    unsigned length() const { return (unsigned)s_.size(); }
+    bool equals(const char *o) const { return s_ == o; }
+
+private:
+    std::string s_;
+};
+
+// Prints are dropped; write() goes to HostSim's serial capture.
+class HardwareSerial
+{
+public:
+    void begin(unsigned long) {}
+    size_t write(const uint8_t *p, size_t n);
+    size_t write(uint8_t b) { return write(&b, 1); }
+    int available() { return 0; }
+    int availableForWrite();
+    template <typename T> size_t print(T) { return 0; }
+    template <typename T> size_t print(T, int) { return 0; }
+    template <typename T> size_t println(T) { return 0; }
+    template <typename T> size_t println(T, int) { return 0; }
+    size_t println() { return 0; }
+    int printf(const char *, ...) { return 0; }
+};
+extern HardwareSerial Serial;
@@ -0,0 +1,490 @@
+#include "HostSim.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <driver/ledc.h>
+#include <driver/rmt_tx.h>
+#include <esp_rom_gpio.h>
+#include <esp_timer.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <soc/gpio_struct.h>
+
+HardwareSerial Serial;
+volatile gpio_dev_t GPIO;
+
+struct esp_timer
+{
+    esp_timer_cb_t cb;
+    void          *arg;
+    int64_t        periodUs;   // 0: one-shot
+    int64_t        nextUs;
+    bool           armed;
+};
+
+struct RmtTransfer
+{
+    std::vector<rmt_symbol_word_t> sym;
+    int64_t startUs;
+    int64_t endUs;
+};
+
+struct rmt_channel_t
+{
+    uint32_t                resHz;
+    rmt_tx_done_callback_t  onDone;
+    void                   *ctx;
+    bool                    enabled;
+    std::deque<RmtTransfer> q;
+};
+
+struct rmt_encoder_t
+{
+    int unused;
+};
+
+namespace
+{
+
+struct Isr
+{
+    void (*plain)();
+    void (*withArg)(void *);
+    void *arg;
+};
+
+int64_t                      now = 0;
+bool                         dispatching = false;
+std::vector<esp_timer *>     timers;
+std::vector<rmt_channel_t *> channels;
+uint8_t                      pins[64];
+std::map<int, Isr>           isrs;
+std::vector<host::PinWrite>  writes;
+host::Ledc                   ledcState;
+host::Rmt                    rmtState;
+int64_t                      ledcOffUs = 0;
+uint32_t                     ledcOffHz = 0;
+std::vector<uint8_t>         serial;
+std::map<std::string, std::vector<uint8_t>> nvs;
+
+bool rmtBusy()
+{
+    for (rmt_channel_t *c : channels)
+        if (!c->q.empty())
+            return true;
+    return false;
+}
+
+// Rising edges of a transfer that start before 'untilUs' (all of them
+// when untilUs is past its end).
+uint64_t edgesBefore(const rmt_channel_t *c, const RmtTransfer &t, int64_t untilUs)
+{
+    uint64_t n = 0;
+    uint64_t tick = 0;
+    for (const rmt_symbol_word_t &s : t.sym)
+    {
+        int64_t at = t.startUs + (int64_t)(tick * 1000000 / c->resHz);
+        if (at >= untilUs)
+            break;
+        if (s.level0 && s.duration0)
+        {
+            n++;
+            rmtState.lastEdgeUs = at;
+        }
+        tick += s.duration0 + s.duration1;
+    }
+    return n;
+}
+
+void finishTransfer(rmt_channel_t *c)
+{
+    RmtTransfer t = c->q.front();
+    c->q.pop_front();
+    rmtState.edges += edgesBefore(c, t, INT64_MAX);
+    rmtState.inFlight--;
+    if (c->onDone)
+    {
+        rmt_tx_done_event_data_t ev = {t.sym.size()};
+        c->onDone(c, &ev, c->ctx);
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- host API
+
+namespace host
+{
+
+void reset()
+{
+    now = 0;
+    timers.clear();
+    channels.clear();
+    memset(pins, 0, sizeof(pins));
+    isrs.clear();
+    writes.clear();
+    ledcState = {};
+    rmtState = {};
+    ledcOffUs = 0;
+    ledcOffHz = 0;
+    serial.clear();
+}
+
+void clearNvs() { nvs.clear(); }
+
+int64_t nowUs() { return now; }
+
+void advanceUs(int64_t us)
+{
+    int64_t until = now + us;
+    if (dispatching)
+    {
+        now = until;   // A callback waiting: time passes, nothing else runs
+        return;
+    }
+
+    dispatching = true;
+    while (true)
+    {
+        // Earliest due event; an RMT completion (interrupt) wins a tie.
+        int64_t        at = until + 1;
+        rmt_channel_t *ch = nullptr;
+        esp_timer     *tm = nullptr;
+        for (rmt_channel_t *c : channels)
+            if (!c->q.empty() && c->q.front().endUs < at)
+            {
+                at = c->q.front().endUs;
+                ch = c;
+            }
+        for (esp_timer *t : timers)
+            if (t->armed && t->nextUs < at)
+            {
+                at = t->nextUs;
+                tm = t;
+                ch = nullptr;
+            }
+        if (!ch && !tm)
+            break;
+
+        if (at > now)
+            now = at;
+        if (ch)
+        {
+            finishTransfer(ch);
+        }
+        else
+        {
+            if (tm->periodUs)
+                tm->nextUs += tm->periodUs;
+            else
+                tm->armed = false;
+            tm->cb(tm->arg);
+        }
+    }
+    dispatching = false;
+    now = until;
+}
+
+const std::vector<PinWrite> &pinWrites() { return writes; }
+
+void setInput(uint8_t pin, int level) { pins[pin] = level ? 1 : 0; }
+
+int pinLevel(uint8_t pin) { return pins[pin]; }
+
+void interrupt(uint8_t pin)
+{
+    auto it = isrs.find(pin);
+    if (it == isrs.end())
+        return;
+    if (it->second.withArg)
+        it->second.withArg(it->second.arg);
+    else if (it->second.plain)
+        it->second.plain();
+}
+
+Ledc &ledc() { return ledcState; }
+
+uint32_t ledcOutputHz()
+{
+    if (ledcState.duty == 0 || ledcState.divQ8 == 0)
+        return 0;
+    uint64_t div = (uint64_t)ledcState.divQ8 << ledcState.bits;
+    return (uint32_t)((((uint64_t)80000000 << 8) + div / 2) / div);
+}
+
+Rmt &rmt() { return rmtState; }
+
+std::vector<uint8_t> &serialOut() { return serial; }
+
+} // namespace host
+
+// ------------------------------------------------------------ Arduino core
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (mode == INPUT_PULLUP)
+        pins[pin] = 1;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    pins[pin] = val ? 1 : 0;
+    writes.push_back({pin, pins[pin], now, ledcState.duty != 0 || rmtBusy(), ledcOffUs, ledcOffHz,
+                      rmtState.lastEdgeUs});
+}
+
+int digitalRead(uint8_t pin) { return pins[pin]; }
+
+unsigned long millis() { return (unsigned long)(now / 1000); }
+unsigned long micros() { return (unsigned long)now; }
+void delay(uint32_t ms) { host::advanceUs((int64_t)ms * 1000); }
+void delayMicroseconds(uint32_t us) { host::advanceUs(us); }
+
+void attachInterrupt(int pin, void (*isr)(), int) { isrs[pin] = {isr, nullptr, nullptr}; }
+void attachInterruptArg(int pin, void (*isr)(void *), void *arg, int) { isrs[pin] = {nullptr, isr, arg}; }
+void detachInterrupt(int pin) { isrs.erase(pin); }
+
+bool ledcAttach(uint8_t, uint32_t, uint8_t bits)
+{
+    ledcState.attaches++;
+    ledcState.bits = bits;
+    return true;
+}
+
+bool ledcAttachChannel(uint8_t pin, uint32_t freq, uint8_t bits, int8_t)
+{
+    return ledcAttach(pin, freq, bits);
+}
+
+bool ledcWrite(uint8_t, uint32_t duty)
+{
+    ledcState.duty = ledcState.pendingDuty = duty;
+    return true;
+}
+
+bool ledcDetach(uint8_t)
+{
+    ledcState.detaches++;
+    ledcState.duty = ledcState.pendingDuty = 0;
+    return true;
+}
+
+uint32_t ledcChangeFrequency(uint8_t, uint32_t freq, uint8_t bits)
+{
+    ledcState.freqChanges++;
+    ledcState.bits = bits;
+    return freq;
+}
+
+size_t HardwareSerial::write(const uint8_t *p, size_t n)
+{
+    serial.insert(serial.end(), p, p + n);
+    return n;
+}
+
+int HardwareSerial::availableForWrite() { return 4096; }
+
+// ---------------------------------------------------------------- esp_timer
+
+int esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    esp_timer *t = new esp_timer{args->callback, args->arg, 0, 0, false};
+    timers.push_back(t);
+    *out = t;
+    return 0;
+}
+
+int esp_timer_start_periodic(esp_timer_handle_t t, uint64_t periodUs)
+{
+    t->periodUs = (int64_t)periodUs;
+    t->nextUs = now + (int64_t)periodUs;
+    t->armed = true;
+    return 0;
+}
+
+int esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs)
+{
+    t->periodUs = 0;
+    t->nextUs = now + (int64_t)timeoutUs;
+    t->armed = true;
+    return 0;
+}
+
+int esp_timer_stop(esp_timer_handle_t t)
+{
+    t->armed = false;
+    return 0;
+}
+
+int64_t esp_timer_get_time() { return now; }
+
+// --------------------------------------------------------------------- LEDC
+
+esp_err_t ledc_set_freq(ledc_mode_t, ledc_timer_t, uint32_t)
+{
+    ledcState.freqChanges++;
+    return ESP_OK;
+}
+
+esp_err_t ledc_timer_set(ledc_mode_t, ledc_timer_t, uint32_t divQ8, uint32_t bits, ledc_clk_src_t)
+{
+    ledcState.timerSets++;
+    ledcState.divQ8 = divQ8;
+    ledcState.bits = bits;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t, ledc_channel_t, uint32_t duty)
+{
+    ledcState.pendingDuty = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t, ledc_channel_t)
+{
+    if (ledcState.duty != 0 && ledcState.pendingDuty == 0)
+    {
+        ledcOffHz = host::ledcOutputHz();
+        ledcOffUs = now;
+    }
+    ledcState.duty = ledcState.pendingDuty;
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------- RMT
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *cfg, rmt_channel_handle_t *out)
+{
+    rmt_channel_t *c = new rmt_channel_t{cfg->resolution_hz, nullptr, nullptr, false, {}};
+    channels.push_back(c);
+    *out = c;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *, rmt_encoder_handle_t *out)
+{
+    *out = new rmt_encoder_t{0};
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t enc)
+{
+    delete enc;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t ch)
+{
+    for (size_t i = 0; i < channels.size(); i++)
+        if (channels[i] == ch)
+            channels.erase(channels.begin() + i);
+    rmtState.inFlight -= (uint32_t)ch->q.size();
+    delete ch;
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t ch)
+{
+    if (ch->enabled)
+        return ESP_FAIL;
+    ch->enabled = true;
+    return ESP_OK;
+}
+
+// Like IDF 5: the transfer being sent stops where it is, and it and the
+// queued ones are recycled without their done callback.
+esp_err_t rmt_disable(rmt_channel_handle_t ch)
+{
+    if (!ch->enabled)
+        return ESP_FAIL;
+    ch->enabled = false;
+    rmtState.disables++;
+    if (!ch->q.empty())
+        rmtState.edges += edgesBefore(ch, ch->q.front(), now);
+    rmtState.inFlight -= (uint32_t)ch->q.size();
+    ch->q.clear();
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t ch, const rmt_tx_event_callbacks_t *cbs,
+                                          void *ctx)
+{
+    ch->onDone = cbs->on_trans_done;
+    ch->ctx = ctx;
+    return ESP_OK;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t ch, rmt_encoder_handle_t, const void *data, size_t bytes,
+                       const rmt_transmit_config_t *)
+{
+    if (!ch->enabled)
+        return ESP_FAIL;
+    RmtTransfer t;
+    const rmt_symbol_word_t *s = (const rmt_symbol_word_t *)data;
+    t.sym.assign(s, s + bytes / sizeof(rmt_symbol_word_t));
+    uint64_t ticks = 0;
+    for (const rmt_symbol_word_t &w : t.sym)
+        ticks += w.duration0 + w.duration1;
+    t.startUs = ch->q.empty() ? now : ch->q.back().endUs;
+    t.endUs = t.startUs + (int64_t)((ticks * 1000000 + ch->resHz - 1) / ch->resHz);
+    ch->q.push_back(t);
+    rmtState.inFlight++;
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t ch, int)
+{
+    while (!ch->q.empty())
+    {
+        if (dispatching)
+            finishTransfer(ch);
+        else
+            host::advanceUs(ch->q.front().endUs - now);
+    }
+    return ESP_OK;
+}
+
+// ------------------------------------------------------------- GPIO matrix
+
+void esp_rom_gpio_connect_out_signal(uint32_t, uint32_t, bool, bool) {}
+
+// ---------------------------------------------------------------------- NVS
+
+bool Preferences::begin(const char *name, bool)
+{
+    ns = name;
+    return true;
+}
+
+String Preferences::getString(const char *k, String d)
+{
+    auto it = nvs.find(ns + "/" + k);
+    return it == nvs.end() ? d : String((const char *)it->second.data());
+}
+
+size_t Preferences::getBytes(const char *k, void *buf, size_t len)
+{
+    auto it = nvs.find(ns + "/" + k);
+    if (it == nvs.end() || it->second.size() > len)
+        return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char *k)
+{
+    auto it = nvs.find(ns + "/" + k);
+    return it == nvs.end() ? 0 : it->second.size();
+}
+
+bool Preferences::remove(const char *k) { return nvs.erase(ns + "/" + k) > 0; }
+
+bool Preferences::isKey(const char *k) { return nvs.count(ns + "/" + k) > 0; }
+
+size_t Preferences::put(const char *k, const void *v, size_t n)
+{
+    const uint8_t *p = (const uint8_t *)v;
+    nvs[ns + "/" + k].assign(p, p + n);
+    return n;
+}
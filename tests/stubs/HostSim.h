@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// ================================= HostSim ==================================
+// The simulated board behind the host stubs. Time only moves when a test
+// says so: advanceUs() steps the clock and, on the way, fires the esp_timer
+// callbacks (the motion tick) and completes RMT transfers, in time order,
+// exactly when they fall due. Pin writes, LEDC calls and RMT output are
+// recorded for the tests to check.
+namespace host
+{
+
+// Back to power-up: time 0, no timers, pins low, logs empty. NVS is kept
+// (clearNvs() empties it), like on the board.
+void reset();
+void clearNvs();
+
+int64_t nowUs();
+void advanceUs(int64_t us);
+inline void advanceMs(int64_t ms) { advanceUs(ms * 1000); }
+
+// ---- Pins ----
+// One write to an output pin, with the CLOCK state at that moment.
+struct PinWrite
+{
+    uint8_t  pin;
+    uint8_t  level;
+    int64_t  atUs;
+    bool     clockOn;        // LEDC duty non-zero, or RMT pulses in flight
+    int64_t  clockOffUs;     // When the LEDC duty last went to 0
+    uint32_t clockOffHz;     // LEDC output frequency at that moment
+    int64_t  rmtLastEdgeUs;  // Last RMT rising edge sent before the write
+};
+const std::vector<PinWrite> &pinWrites();
+void setInput(uint8_t pin, int level);
+int pinLevel(uint8_t pin);
+// Run the handler attached to 'pin' (attachInterrupt/attachInterruptArg).
+void interrupt(uint8_t pin);
+
+// ---- LEDC ----
+struct Ledc
+{
+    uint32_t attaches;       // ledcAttach / ledcAttachChannel
+    uint32_t detaches;       // ledcDetach
+    uint32_t freqChanges;    // ledcChangeFrequency / ledc_set_freq
+    uint32_t timerSets;      // ledc_timer_set (in-place retune)
+    uint32_t divQ8;          // Timer divider, Q10.8
+    uint32_t bits;           // Duty resolution
+    uint32_t duty;           // Duty latched by ledc_update_duty()
+    uint32_t pendingDuty;    // Written by ledc_set_duty(), not yet latched
+};
+Ledc &ledc();
+// Frequency the timer produces (Hz, rounded), 0 while the duty is 0.
+uint32_t ledcOutputHz();
+
+// ---- RMT ----
+struct Rmt
+{
+    uint64_t edges;          // Rising edges that reached the pin
+    int64_t  lastEdgeUs;     // Time of the last one
+    uint32_t inFlight;       // Transfers queued or being sent
+    uint32_t disables;       // rmt_disable() calls
+};
+Rmt &rmt();
+
+// ---- Serial ----
+std::vector<uint8_t> &serialOut();
+
+} // namespace host
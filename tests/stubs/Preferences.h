@@ -0,0 +1,43 @@
+#pragma once
+// Host NVS: one in-memory store shared by every Preferences object, kept
+// for the life of the process (host::clearNvs() empties it).
+#include <Arduino.h>
+
+class Preferences
+{
+public:
+    bool begin(const char *ns, bool readOnly = false);
+    void end() {}
+
+    bool     getBool(const char *k, bool d = false)         { return get(k, d); }
+    uint8_t  getUChar(const char *k, uint8_t d = 0)         { return get(k, d); }
+    uint16_t getUShort(const char *k, uint16_t d = 0)       { return get(k, d); }
+    int16_t  getShort(const char *k, int16_t d = 0)         { return get(k, d); }
+    uint32_t getUInt(const char *k, uint32_t d = 0)         { return get(k, d); }
+    int32_t  getInt(const char *k, int32_t d = 0)           { return get(k, d); }
+    String   getString(const char *k, String d = String());
+    size_t   getBytes(const char *k, void *buf, size_t len);
+    size_t   getBytesLength(const char *k);
+
+    size_t putBool(const char *k, bool v)          { return put(k, &v, sizeof(v)); }
+    size_t putUChar(const char *k, uint8_t v)      { return put(k, &v, sizeof(v)); }
+    size_t putUShort(const char *k, uint16_t v)    { return put(k, &v, sizeof(v)); }
+    size_t putShort(const char *k, int16_t v)      { return put(k, &v, sizeof(v)); }
+    size_t putUInt(const char *k, uint32_t v)      { return put(k, &v, sizeof(v)); }
+    size_t putInt(const char *k, int32_t v)        { return put(k, &v, sizeof(v)); }
+    size_t putString(const char *k, const char *v) { return put(k, v, strlen(v) + 1); }
+    size_t putBytes(const char *k, const void *v, size_t n) { return put(k, v, n); }
+
+    bool remove(const char *k);
+    bool isKey(const char *k);
+
+private:
+    template <typename T> T get(const char *k, T d)
+    {
+        T v;
+        return getBytesLength(k) == sizeof(T) && getBytes(k, &v, sizeof(T)) == sizeof(T) ? v : d;
+    }
+    size_t put(const char *k, const void *v, size_t n);
+
+    std::string ns;
+};
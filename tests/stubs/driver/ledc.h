@@ -0,0 +1,18 @@
+#pragma once
+// Host LEDC driver calls, recorded by HostSim (host::ledc()).
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef enum { LEDC_LOW_SPEED_MODE = 0 } ledc_mode_t;
+typedef enum { LEDC_TIMER_0 = 0, LEDC_TIMER_1, LEDC_TIMER_2, LEDC_TIMER_3 } ledc_timer_t;
+typedef enum { LEDC_CHANNEL_0 = 0 } ledc_channel_t;
+typedef enum { LEDC_APB_CLK = 1 } ledc_clk_src_t;
+
+esp_err_t ledc_set_freq(ledc_mode_t mode, ledc_timer_t timer, uint32_t hz);
+esp_err_t ledc_timer_set(ledc_mode_t mode, ledc_timer_t timer, uint32_t divQ8, uint32_t bits,
+                         ledc_clk_src_t src);
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t ch, uint32_t duty);
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t ch);
@@ -0,0 +1,64 @@
+#pragma once
+// Host RMT TX driver: transfers play out in host time (HostSim.cpp).
+#include <stdint.h>
+#include <stddef.h>
+#include "ledc.h"
+
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+typedef struct rmt_encoder_t *rmt_encoder_handle_t;
+typedef enum { RMT_CLK_SRC_DEFAULT = 0 } rmt_clock_source_t;
+
+typedef union
+{
+    struct
+    {
+        uint16_t duration0 : 15;
+        uint16_t level0 : 1;
+        uint16_t duration1 : 15;
+        uint16_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef struct
+{
+    int                gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t           resolution_hz;
+    size_t             mem_block_symbols;
+    size_t             trans_queue_depth;
+    int                intr_priority;
+    struct
+    {
+        uint32_t invert_out : 1;
+        uint32_t with_dma : 1;
+        uint32_t io_loop_back : 1;
+        uint32_t io_od_mode : 1;
+    } flags;
+} rmt_tx_channel_config_t;
+
+typedef struct
+{
+    int loop_count;
+    struct
+    {
+        uint32_t eot_level : 1;
+    } flags;
+} rmt_transmit_config_t;
+
+typedef struct { size_t num_symbols; } rmt_tx_done_event_data_t;
+typedef bool (*rmt_tx_done_callback_t)(rmt_channel_handle_t, const rmt_tx_done_event_data_t *, void *);
+typedef struct { rmt_tx_done_callback_t on_trans_done; } rmt_tx_event_callbacks_t;
+typedef struct { int unused; } rmt_copy_encoder_config_t;
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *cfg, rmt_channel_handle_t *out);
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *cfg, rmt_encoder_handle_t *out);
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t enc);
+esp_err_t rmt_del_channel(rmt_channel_handle_t ch);
+esp_err_t rmt_enable(rmt_channel_handle_t ch);
+esp_err_t rmt_disable(rmt_channel_handle_t ch);
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t ch, const rmt_tx_event_callbacks_t *cbs,
+                                          void *ctx);
+esp_err_t rmt_transmit(rmt_channel_handle_t ch, rmt_encoder_handle_t enc, const void *data, size_t bytes,
+                       const rmt_transmit_config_t *cfg);
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t ch, int timeoutMs);
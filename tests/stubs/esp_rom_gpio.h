@@ -0,0 +1,4 @@
+#pragma once
+#include <stdint.h>
+
+void esp_rom_gpio_connect_out_signal(uint32_t gpio, uint32_t signal, bool outInv, bool oenInv);
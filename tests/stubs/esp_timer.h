@@ -0,0 +1,21 @@
+#pragma once
+// Host esp_timer: callbacks fire from host::advanceUs() (HostSim.h).
+#include <stdint.h>
+
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+typedef enum { ESP_TIMER_TASK, ESP_TIMER_ISR } esp_timer_dispatch_t;
+typedef struct
+{
+    esp_timer_cb_t       callback;
+    void                *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char          *name;
+    bool                 skip_unhandled_events;
+} esp_timer_create_args_t;
+
+int esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out);
+int esp_timer_start_periodic(esp_timer_handle_t t, uint64_t periodUs);
+int esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs);
+int esp_timer_stop(esp_timer_handle_t t);
+int64_t esp_timer_get_time();
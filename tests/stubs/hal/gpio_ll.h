@@ -0,0 +1,7 @@
+#pragma once
+// Register-level pin access maps onto the simulated pins.
+#include <Arduino.h>
+#include "soc/gpio_struct.h"
+
+static inline void gpio_ll_set_level(volatile gpio_dev_t *, uint32_t n, uint32_t l) { digitalWrite(n, l); }
+static inline int gpio_ll_get_level(volatile gpio_dev_t *, uint32_t n) { return digitalRead(n); }
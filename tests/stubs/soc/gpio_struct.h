@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+
+typedef union
+{
+    struct
+    {
+        uint32_t out_sel : 9;
+        uint32_t inv_sel : 1;
+        uint32_t oen_sel : 1;
+        uint32_t oen_inv_sel : 1;
+    };
+    uint32_t val;
+} gpio_func_out_sel_cfg_reg_t;
+
+typedef struct
+{
+    uint32_t out;
+    uint32_t in;
+    gpio_func_out_sel_cfg_reg_t func_out_sel_cfg[49];
+} gpio_dev_t;
+
+extern volatile gpio_dev_t GPIO;
@@ -0,0 +1,137 @@
+// RelayAutotune against a first-order plant with dead time:
+// RPM' = (K * Hz(t - L) - RPM) / TAU, sampled every RPM_MIN_WINDOW_MS.
+//
+// For this plant the relay limit cycle is known exactly (half-swing d,
+// hysteresis e, effective delay L' = L + half a sample):
+//   amplitude  a = K d (1 - exp(-L'/TAU)) + e exp(-L'/TAU)
+//   period     Tu = 2 (L' + TAU ln((K d + a) / (K d - e)))
+// The tuner must find that cycle and turn it into Ziegler-Nichols gains.
+// Those in turn approximate ZN at the plant's true ultimate point (the
+// describing function ignores the harmonics of the relay's square wave),
+// closely only where the dead time is not small against TAU.
+#include "Check.h"
+#include "Config.h"
+#include "Autotune.h"
+#include <math.h>
+#include <vector>
+
+namespace
+{
+
+const double   K = 2.5;            // RPM per Hz
+const uint32_t BASE_HZ = 1000;
+const uint32_t SAMPLE_MS = RPM_MIN_WINDOW_MS;
+
+struct Result
+{
+    RelayAutotune::State state;
+    uint32_t endMs;
+};
+
+// Run the tuner on the plant until it finishes; 'gain' scales K (0 = no
+// response at all).
+Result run(RelayAutotune &at, double L, double tau, double gain = 1.0)
+{
+    const uint32_t relayHz = BASE_HZ * AUTOTUNE_RELAY_PCT / 100;
+    std::vector<uint32_t> line((size_t)lround(L * 1000) + 1, BASE_HZ);
+    size_t head = 0;
+    double rpm = K * gain * BASE_HZ;    // Steady at the base clock
+    uint32_t cmd = BASE_HZ;
+    at.begin(BASE_HZ, relayHz, 0);
+    uint32_t t = 0;
+    while (at.active() && t < AUTOTUNE_MAX_MS + 1000)
+    {
+        t++;
+        line[head] = cmd;
+        head = (head + 1) % line.size();
+        rpm += (K * gain * line[head] - rpm) / tau * 0.001;
+        if (t % SAMPLE_MS == 0)
+            cmd = at.update((uint32_t)lround(rpm), t, true);
+    }
+    return {at.state(), t};
+}
+
+// Exact relay cycle and the gains the tuner should derive from it.
+void checkCycle(double L, double tau)
+{
+    RelayAutotune at;
+    Result r = run(at, L, tau);
+    CHECK(r.state == RelayAutotune::AT_DONE);
+    CHECK(at.cyclesDone() == AUTOTUNE_CYCLES);
+    CHECK(at.setpointRpm() == (uint32_t)(K * BASE_HZ));
+
+    const double d = BASE_HZ * AUTOTUNE_RELAY_PCT / 100.0;
+    const double e = AUTOTUNE_HYST_RPM;
+    const double Le = L + SAMPLE_MS / 2000.0;
+    double a = K * d * (1 - exp(-Le / tau)) + e * exp(-Le / tau);
+    double tu = 2 * (Le + tau * log((K * d + a) / (K * d - e)));
+    CHECK_NEAR(at.amplitudeRpm(), a, a * 0.05);
+    CHECK_NEAR(at.tuMs(), tu * 1000, SAMPLE_MS + tu * 1000 * 0.02);   // Switches land on samples
+
+    // Ziegler-Nichols on the measured cycle, in milli-units.
+    double ku = 4 * d / (M_PI * at.amplitudeRpm());
+    CHECK_NEAR(at.kpMilli(), 0.45 * ku * 1000, 2);
+    CHECK_NEAR(at.kiMilli(), 0.54 * ku / (at.tuMs() / 1000.0) * 1000, 2);
+}
+
+// Ultimate gain and period of K exp(-Ls) / (TAU s + 1): phase -180 deg.
+void ultimate(double L, double tau, double &ku, double &tu)
+{
+    double lo = 0, hi = 1e4;
+    for (int i = 0; i < 100; i++)
+    {
+        double w = (lo + hi) / 2;
+        (atan(w * tau) + w * L < M_PI ? lo : hi) = w;
+    }
+    ku = sqrt(1 + lo * lo * tau * tau) / K;
+    tu = 2 * M_PI / lo;
+}
+
+// Dead time equal to TAU: the relay estimate is within 25% of ZN at the
+// true ultimate point, on the safe (lower gain) side.
+void testAgainstTrueUltimate()
+{
+    const double L = 0.5, tau = 0.5;
+    RelayAutotune at;
+    CHECK(run(at, L, tau).state == RelayAutotune::AT_DONE);
+    double ku, tu;
+    ultimate(L, tau, ku, tu);
+    double kp = 0.45 * ku * 1000, ki = 0.54 * ku / tu * 1000;
+    CHECK(at.kpMilli() <= kp && at.kpMilli() > kp * 0.75);
+    CHECK(at.kiMilli() <= ki && at.kiMilli() > ki * 0.75);
+    CHECK_NEAR(at.tuMs(), tu * 1000, tu * 1000 * 0.1);
+}
+
+// No FG response: the setpoint reads 0 and the test fails at once.
+void testNoResponse()
+{
+    RelayAutotune at;
+    Result r = run(at, 0.1, 0.5, 0.0);
+    CHECK(r.state == RelayAutotune::AT_FAILED);
+    CHECK(r.endMs <= AUTOTUNE_SETTLE_MS + SAMPLE_MS);
+}
+
+// A swing that never clears the hysteresis: no cycle, and the test gives
+// up at AUTOTUNE_MAX_MS.
+void testBoundedTime()
+{
+    RelayAutotune at;
+    double gain = AUTOTUNE_HYST_RPM / (K * BASE_HZ * AUTOTUNE_RELAY_PCT / 100.0) / 2;
+    Result r = run(at, 0.1, 0.5, gain);
+    CHECK(r.state == RelayAutotune::AT_FAILED);
+    CHECK(r.endMs > AUTOTUNE_MAX_MS && r.endMs <= AUTOTUNE_MAX_MS + SAMPLE_MS);
+}
+
+} // namespace
+
+int main()
+{
+    checkCycle(0.5, 0.5);
+    checkCycle(0.3, 0.5);
+    checkCycle(0.1, 0.5);
+    checkCycle(0.2, 1.0);
+    testAgainstTrueUltimate();
+    testNoResponse();
+    testBoundedTime();
+    return checkExit("test_autotune");
+}
@@ -0,0 +1,222 @@
+// FgCalibrator against a motor giving k FG edges per clock pulse, fed
+// CAL_SAMPLE_MS windows as the RPM sampler would. Checks the fitted k and
+// what follows from it (PPR from clock pulses per rev and the reverse), the
+// CAL_MAX_DEV_PCT limit on a point off the line, the CAL_MIN_EDGES count
+// per point, and, through MotorRuntime, which of ppr and clockPerRev a
+// finished calibration updates.
+#include "Check.h"
+#include "HostSim.h"
+#include "Motor.h"
+#include <math.h>
+
+namespace
+{
+
+const uint32_t TOP_HZ = 2000;
+
+struct Result
+{
+    FgCalibrator::State state;
+    uint32_t endMs;
+};
+
+// Run the calibrator up to 'top' until it finishes. FG edges come at k per
+// clock pulse, times 1 + 'err' at the lowest point; fractions carry over
+// between windows. 'firstMs' is when the first point was done (0 if never).
+Result run(FgCalibrator &cal, double k, double err = 0, uint32_t *firstMs = nullptr,
+           uint32_t top = TOP_HZ)
+{
+    cal.begin(top, 0);
+    uint32_t hz = cal.currentPointHz();
+    double carry = 0;
+    uint32_t t = 0;
+    if (firstMs)
+        *firstMs = 0;
+    while (cal.active() && t <= CAL_MAX_MS + CAL_SAMPLE_MS)
+    {
+        t += CAL_SAMPLE_MS;
+        double edges = carry + k * hz * CAL_SAMPLE_MS / 1000.0 *
+                       (cal.pointsDone() == 0 ? 1 + err : 1);
+        uint32_t n = (uint32_t)edges;
+        carry = edges - n;
+        uint32_t next = cal.update(n, CAL_SAMPLE_MS, hz, t, true);
+        if (firstMs && !*firstMs && cal.pointsDone() > 0)
+            *firstMs = t;
+        if (next != hz)
+            carry = 0;
+        hz = next;
+    }
+    return {cal.state(), t};
+}
+
+// 4 edges per rev on 20 clock pulses per rev (a BLDC driver), and on a
+// 3200 microstep stepper: k and both conversions come out exact.
+void testFit()
+{
+    FgCalibrator cal;
+    CHECK(run(cal, 4.0 / 20).state == FgCalibrator::CAL_DONE);
+    CHECK(cal.pointsDone() == CAL_POINTS);
+    CHECK_NEAR(cal.edgesPerClockPpm(), 200000, 200);
+    CHECK(cal.maxDeviationPct() == 0);
+    CHECK(cal.pprFor(20) == 4);
+    CHECK(cal.pprFor(60) == 12);
+    CHECK(cal.clockPerRevFor(4) == 20);
+    CHECK(cal.clockPerRevFor(6) == 30);
+    CHECK(cal.pprFor(2000) == 0);           // 400: no such PPR
+    CHECK(cal.pprFor(1) == 0);              // 0.2 rounds to nothing
+
+    // The stepper needs a far higher clock for as many edges.
+    CHECK(run(cal, 4.0 / 3200, 0, nullptr, 64000).state == FgCalibrator::CAL_DONE);
+    CHECK_NEAR(cal.edgesPerClockPpm(), 1250, 2);
+    CHECK(cal.pprFor(3200) == 4);
+    CHECK_NEAR(cal.clockPerRevFor(4), 3200, 5);
+    CHECK(cal.topHz() == 64000);
+}
+
+// The lowest point off by 'err': the fit shifts a little towards it, and
+// the result is refused once that point ends up more than CAL_MAX_DEV_PCT
+// from the line. The expected deviation comes from the same fit in floats.
+void testDeviation()
+{
+    const double k = 4.0 / 20;
+    for (int i = 0; i <= 30; i++)
+    {
+        double err = i * 0.005;
+        double sxy = 0, sxx = 0;
+        for (int p = 0; p < CAL_POINTS; p++)
+        {
+            double x = (double)TOP_HZ * (p + 1) / CAL_POINTS;
+            sxy += x * k * x * (p == 0 ? 1 + err : 1);
+            sxx += x * x;
+        }
+        double dev = fabs((1 + err) / (sxy / sxx / k) - 1) * 100;
+
+        FgCalibrator cal;
+        FgCalibrator::State st = run(cal, k, err).state;
+        if (dev < CAL_MAX_DEV_PCT + 0.9 && dev > CAL_MAX_DEV_PCT + 0.1)
+            continue;                       // Too close to call in integers
+        CHECK(st == (dev < CAL_MAX_DEV_PCT + 1 ? FgCalibrator::CAL_DONE
+                                               : FgCalibrator::CAL_FAILED));
+        if (st == FgCalibrator::CAL_DONE)
+            CHECK_NEAR(cal.maxDeviationPct(), dev, 1);
+    }
+
+    FgCalibrator cal;
+    CHECK(run(cal, k, -0.5).state == FgCalibrator::CAL_FAILED);
+}
+
+// A point is measured at least CAL_MEASURE_MS and until CAL_MIN_EDGES
+// have been counted, from the window that closes CAL_SETTLE_MS after the
+// clock got there; too few edges in all, and it runs out of time.
+void testEdges()
+{
+    FgCalibrator cal;
+    uint32_t firstMs;
+
+    // Plenty: the first point ends after settling and measuring.
+    run(cal, 4.0 / 20, 0, &firstMs);
+    CHECK(firstMs == CAL_SETTLE_MS - CAL_SAMPLE_MS + CAL_MEASURE_MS);
+
+    // 25 edges/s at the first point: it takes CAL_MIN_EDGES / 25 s.
+    double k = 25.0 / (TOP_HZ / CAL_POINTS);
+    CHECK(run(cal, k, 0, &firstMs).state == FgCalibrator::CAL_DONE);
+    CHECK(firstMs == CAL_SETTLE_MS - CAL_SAMPLE_MS + CAL_MIN_EDGES * 1000 / 25);
+
+    // Fewer than CAL_MIN_EDGES in CAL_MAX_MS at any point.
+    k = (CAL_MIN_EDGES - 1) * 1000.0 / CAL_MAX_MS / TOP_HZ;
+    Result r = run(cal, k);
+    CHECK(r.state == FgCalibrator::CAL_FAILED);
+    CHECK(r.endMs > CAL_MAX_MS && r.endMs <= CAL_MAX_MS + CAL_SAMPLE_MS);
+
+    // None at all.
+    r = run(cal, 0);
+    CHECK(r.state == FgCalibrator::CAL_FAILED);
+    CHECK(cal.pointsDone() == 0);
+}
+
+// A motor whose FG follows the clock at 'k' edges per pulse, with loop()
+// sampling the RPM every ms.
+void spin(MotorRuntime &m, double k, int64_t &nextUs, uint32_t ms)
+{
+    int64_t end = host::nowUs() + (int64_t)ms * 1000;
+    int64_t nextMs = host::nowUs() + 1000;
+    while (host::nowUs() < end)
+    {
+        uint32_t hz = m.currentHz;
+        if (hz == 0)
+            nextUs = 0;
+        else if (nextUs == 0)
+            nextUs = host::nowUs() + (int64_t)(1e6 / (k * hz));
+        int64_t to = (nextUs && nextUs < nextMs) ? nextUs : nextMs;
+        host::advanceUs(to - host::nowUs());
+        if (nextUs && host::nowUs() >= nextUs)
+        {
+            host::interrupt(PIN_FG);
+            nextUs += (int64_t)(1e6 / (k * hz));
+        }
+        if (host::nowUs() >= nextMs)
+        {
+            m.sampleRPM();
+            nextMs += 1000;
+        }
+    }
+}
+
+// Through MotorRuntime: runs a calibration to the end and returns the
+// profile it leaves.
+MotorProfile calibrate(double k, uint8_t ppr, uint32_t clockPerRev)
+{
+    host::reset();
+    MotorRuntime m;
+    m.begin();
+    MotorProfile p;
+    p.setDefaults();
+    p.hasFG       = true;
+    p.ppr         = ppr;
+    p.clockPerRev = clockPerRev;
+    p.startHz     = 100;
+    p.accelHzS    = 5000;
+    p.decelHzS    = 5000;
+    m.applyProfile(p);
+    m.setTargetHz(TOP_HZ);
+    m.start();
+    int64_t nextUs = 0;
+    spin(m, k, nextUs, 1000);
+    CHECK(m.currentHz == TOP_HZ);
+    CHECK(m.startCalibration());
+
+    for (uint32_t ms = 0; m.isCalibrating() && ms < CAL_MAX_MS + 1000; ms += 100)
+        spin(m, k, nextUs, 100);
+    CHECK(!m.isCalibrating());
+    CHECK(m.calibrator().state() == FgCalibrator::CAL_DONE);
+    CHECK(m.targetHz == TOP_HZ);
+    return m.prof;
+}
+
+// clockPerRev known: the PPR is what is learned. Otherwise the entered PPR
+// stays and clockPerRev is derived from it.
+void testMotor()
+{
+    MotorProfile p = calibrate(4.0 / 20, 2, 20);
+    CHECK(p.ppr == 4);
+    CHECK(p.clockPerRev == 20);
+
+    p = calibrate(4.0 / 20, 4, 0);
+    CHECK(p.ppr == 4);
+    CHECK(p.clockPerRev == 20);
+
+    p = calibrate(6.0 / 50, 6, 0);
+    CHECK(p.ppr == 6);
+    CHECK(p.clockPerRev == 50);
+}
+
+} // namespace
+
+int main()
+{
+    testFit();
+    testDeviation();
+    testEdges();
+    testMotor();
+    return checkExit("test_calibrate");
+}
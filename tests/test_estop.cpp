@@ -0,0 +1,100 @@
+// Emergency stop, and stop() with STOP_CUT, on the RMT backend: no CLOCK
+// edge may leave after the tick that handled it, even at a few Hz where
+// every queued chunk is a pulse long, and emittedPulses() must match the
+// edges actually sent.
+#include "Check.h"
+#include "HostSim.h"
+#include "Motor.h"
+
+namespace
+{
+
+MotorProfile rmtProfile(uint8_t stopMode = STOP_RAMP)
+{
+    MotorProfile p;
+    p.setDefaults();
+    p.pulseBackend = PULSE_RMT;
+    p.stopMode     = stopMode;
+    p.startHz      = 1;
+    p.accelHzS     = 1000;
+    p.decelHzS     = 1000;
+    return p;
+}
+
+// Run at 'hz' for 'runMs', cut (estop, or stop() of a STOP_CUT profile),
+// and check nothing follows.
+void cutAt(uint32_t hz, uint32_t runMs, bool estop)
+{
+    host::reset();
+    MotorRuntime m;
+    m.begin();
+    m.applyProfile(rmtProfile(estop ? STOP_RAMP : STOP_CUT));
+    m.setTargetHz(hz);
+    m.start();
+    host::advanceMs(runMs);
+    CHECK(host::rmt().edges > 0);
+    CHECK(host::rmt().inFlight > 0);
+
+    if (estop)
+        m.emergencyStop();
+    else
+        m.stop();
+    host::advanceMs(1);                 // The tick handles the request
+    int64_t stopUs = host::nowUs();
+    uint64_t edges = host::rmt().edges;
+    CHECK(m.currentHz == 0);
+    CHECK(host::rmt().inFlight == 0);
+    CHECK(m.emittedPulses() == edges);
+
+    // Long enough for every chunk that was queued to have gone out.
+    host::advanceMs(5000);
+    CHECK(host::rmt().edges == edges);
+    CHECK(host::rmt().lastEdgeUs < stopUs);
+    CHECK(m.emittedPulses() == edges);
+
+    // The channel is usable again.
+    m.start();
+    host::advanceMs(runMs);
+    CHECK(host::rmt().edges > edges);
+    m.stop();
+    host::advanceMs(20000);
+    CHECK(m.emittedPulses() == host::rmt().edges);
+}
+
+// A positioned move is cut as well, and ends.
+void testEstopMove()
+{
+    host::reset();
+    MotorRuntime m;
+    m.begin();
+    m.applyProfile(rmtProfile());
+    CHECK(m.moveSteps(100000));
+    host::advanceMs(2000);
+    uint64_t before = host::rmt().edges;
+    CHECK(before > 0 && before < 100000);
+
+    m.emergencyStop();
+    host::advanceMs(2);
+    uint64_t edges = host::rmt().edges;
+    CHECK(m.emittedPulses() == edges);
+    host::advanceMs(5000);
+    CHECK(host::rmt().edges == edges);
+    CHECK(m.moveSteps(10));
+    host::advanceMs(5000);
+    CHECK(host::rmt().edges == edges + 10);
+    CHECK(m.emittedPulses() == edges + 10);
+}
+
+} // namespace
+
+int main()
+{
+    for (bool estop : {true, false})
+    {
+        cutAt(2, 3000, estop);      // Chunks of one pulse: seconds queued
+        cutAt(37, 1500, estop);
+        cutAt(5000, 2000, estop);   // Cut in the middle of a chunk
+    }
+    testEstopMove();
+    return checkExit("test_estop");
+}
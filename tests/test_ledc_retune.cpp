@@ -0,0 +1,117 @@
+// LEDC CLOCK retune: once begin() has attached the pin, every frequency
+// change (ramp steps, retargets, stops and restarts) must retune the timer
+// in place (ledc_timer_set) and never detach or re-attach the pin, which
+// would restart the timer and glitch the pulse train.
+#include "Check.h"
+#include "HostSim.h"
+#include "Motor.h"
+
+namespace
+{
+
+MotorProfile ledcProfile()
+{
+    MotorProfile p;
+    p.setDefaults();
+    p.maxClockHz = 200000;
+    p.accelHzS   = 200000;
+    p.decelHzS   = 200000;
+    return p;
+}
+
+// Tick by tick until the clock sits on 'hz' (or 'maxMs' ran out); meanwhile
+// a running clock must always be on, at 50% duty, at the frequency set.
+bool runTo(MotorRuntime &m, uint32_t hz, uint32_t maxMs)
+{
+    for (uint32_t t = 0; t < maxMs; t++)
+    {
+        host::advanceMs(1);
+        uint32_t cur = m.currentHz;
+        if (cur > 0)
+        {
+            const host::Ledc &l = host::ledc();
+            CHECK(l.duty == 1u << (l.bits - 1));
+            ClockSetting cs = ClockSolver::solve(cur);
+            CHECK(l.divQ8 == cs.divQ8 && l.bits == cs.bits);
+            CHECK_NEAR(host::ledcOutputHz(), cs.actualHz, 1);
+        }
+        if (cur == hz)
+            return true;
+    }
+    return false;
+}
+
+void testNoReattachAfterBegin()
+{
+    host::reset();
+    MotorRuntime m;
+    m.begin();
+    CHECK(host::ledc().attaches == 1);
+    CHECK(host::ledc().duty == 0);
+
+    m.applyProfile(ledcProfile());
+    uint32_t attaches = host::ledc().attaches;
+
+    m.setTargetHz(1000);
+    m.start();
+    CHECK(runTo(m, 1000, 2000));
+
+    // Up and down across the whole resolution range, retargeting mid-ramp
+    // now and then.
+    const uint32_t targets[] = {50, 200000, 37, 150000, 5, 99999, 12345, 640, 80000, 7};
+    for (uint32_t hz : targets)
+    {
+        m.setTargetHz(hz);
+        CHECK(runTo(m, hz, 20000));
+        m.setTargetHz(hz * 2 + 100);
+        runTo(m, 0, 300);
+        m.setTargetHz(hz);
+        CHECK(runTo(m, hz, 20000));
+    }
+
+    // A ramped stop, a restart and a cut.
+    m.stop();
+    CHECK(runTo(m, 0, 20000));
+    CHECK(host::ledc().duty == 0);
+    m.setTargetHz(3000);
+    m.start();
+    CHECK(runTo(m, 3000, 5000));
+    m.emergencyStop();
+    CHECK(runTo(m, 0, 10));
+    CHECK(host::ledc().duty == 0);
+
+    const host::Ledc &l = host::ledc();
+    CHECK(l.attaches == attaches);
+    CHECK(l.detaches == 0);
+    CHECK(l.freqChanges == 0);
+    CHECK(l.timerSets > 1000);
+}
+
+// Clamps to the hardware range go through the same in-place path.
+void testClampsRetuneInPlace()
+{
+    host::reset();
+    MotorRuntime m;
+    m.begin();
+    MotorProfile p = ledcProfile();
+    p.maxClockHz = 1000000;
+    m.applyProfile(p);
+
+    m.setTargetHz(1);
+    m.start();
+    CHECK(runTo(m, ClockSolver::HW_MIN_HZ, 1000));
+    CHECK(m.clampReason == MotorRuntime::CLAMP_HW_MIN);
+
+    CHECK(host::ledc().attaches == 1);
+    CHECK(host::ledc().detaches == 0);
+    CHECK(host::ledc().freqChanges == 0);
+}
+
+} // namespace
+
+int main()
+{
+    testNoReattachAfterBegin();
+    testClampsRetuneInPlace();
+    return checkExit("test_ledc_retune");
+}
@@ -0,0 +1,198 @@
+// ProfileStore::load(): fields read back from NVS out of range (a corrupt
+// or hand-edited store, or one written by another build) come back
+// sanitized; fields in range are left alone.
+#include "Check.h"
+#include "HostSim.h"
+#include "Profiles.h"
+
+namespace
+{
+
+// Save 'p' in slot 0, overwrite some raw keys, and load it back.
+MotorProfile roundTrip(const MotorProfile &p, void (*poke)(Preferences &))
+{
+    host::clearNvs();
+    ProfileStore store;
+    store.begin();
+    CHECK(store.append(p));
+    Preferences raw;
+    raw.begin("motors", false);
+    poke(raw);
+    raw.end();
+
+    MotorProfile out;
+    out.setDefaults();
+    CHECK(store.load(0, out));
+    return out;
+}
+
+void testInRangeUntouched()
+{
+    MotorProfile p;
+    p.setDefaults();
+    p.pulseBackend = PULSE_RMT;
+    p.stopMode = STOP_RAMP_BRAKE;
+    p.accelHzS = 7000;
+    p.decelHzS = 300;
+    p.startHz = 120;
+    p.maxClockHz = 50000;
+    p.ppr = 255;
+    p.kpMilli = SPEED_GAIN_MAX_MILLI;
+    p.kiMilli = 0;
+    p.clockPerRev = SLIP_CLOCK_REV_MAX;
+    MotorProfile out = roundTrip(p, [](Preferences &) {});
+    CHECK(out.pulseBackend == PULSE_RMT);
+    CHECK(out.stopMode == STOP_RAMP_BRAKE);
+    CHECK(out.accelHzS == 7000);
+    CHECK(out.decelHzS == 300);
+    CHECK(out.startHz == 120);
+    CHECK(out.maxClockHz == 50000);
+    CHECK(out.ppr == 255);
+    CHECK(out.kpMilli == SPEED_GAIN_MAX_MILLI);
+    CHECK(out.kiMilli == 0);
+    CHECK(out.clockPerRev == SLIP_CLOCK_REV_MAX);
+}
+
+void testEnumsFallBack()
+{
+    MotorProfile p;
+    p.setDefaults();
+    MotorProfile out = roundTrip(p, [](Preferences &r) {
+        r.putUChar("m0_pb", 7);
+        r.putUChar("m0_stm", 200);
+    });
+    CHECK(out.pulseBackend == PULSE_LEDC);
+    CHECK(out.stopMode == STOP_RAMP);
+}
+
+void testLongNameTerminated()
+{
+    MotorProfile p;
+    p.setDefaults();
+    MotorProfile out = roundTrip(p, [](Preferences &r) {
+        r.putString("m0_name", "A name far longer than the profile field");
+    });
+    CHECK(strlen(out.name) == sizeof(out.name) - 1);
+    CHECK(strncmp(out.name, "A name far longer", 17) == 0);
+}
+
+void testRatesClamped()
+{
+    MotorProfile p;
+    p.setDefaults();
+    // A zero rate would stall the planner forever.
+    MotorProfile out = roundTrip(p, [](Preferences &r) {
+        r.putUInt("m0_acc", 0);
+        r.putUInt("m0_dec", 4000000000u);
+    });
+    CHECK(out.accelHzS == RAMP_RATE_MIN_HZ_S);
+    CHECK(out.decelHzS == RAMP_RATE_MAX_HZ_S);
+}
+
+void testStartHzClamped()
+{
+    MotorProfile p;
+    p.setDefaults();
+    p.maxClockHz = 5000;
+    MotorProfile out = roundTrip(p, [](Preferences &r) { r.putUInt("m0_sth", 90000); });
+    CHECK(out.startHz == 5000);
+
+    out = roundTrip(p, [](Preferences &r) { r.putUInt("m0_sth", 0); });
+    CHECK(out.startHz == ClockSolver::HW_MIN_HZ);
+
+    // The floor follows the backend.
+    p.pulseBackend = PULSE_RMT;
+    out = roundTrip(p, [](Preferences &r) { r.putUInt("m0_sth", 0); });
+    CHECK(out.startHz == RmtPulseEngine::MIN_HZ);
+}
+
+// No FG edges per turn would divide by zero in the RPM estimate.
+void testPprZero()
+{
+    MotorProfile p;
+    p.setDefaults();
+    MotorProfile out = roundTrip(p, [](Preferences &r) { r.putUChar("m0_ppr", 0); });
+    CHECK(out.ppr == 1);
+}
+
+// Gains written as negative numbers read back as huge unsigned ones.
+void testGainsClamped()
+{
+    MotorProfile p;
+    p.setDefaults();
+    MotorProfile out = roundTrip(p, [](Preferences &r) {
+        r.putUInt("m0_kp", (uint32_t)-200);
+        r.putUInt("m0_ki", SPEED_GAIN_MAX_MILLI + 1);
+    });
+    CHECK(out.kpMilli == SPEED_GAIN_MAX_MILLI);
+    CHECK(out.kiMilli == SPEED_GAIN_MAX_MILLI);
+
+    out = roundTrip(p, [](Preferences &r) { r.putUInt("m0_kp", 0); });
+    CHECK(out.kpMilli == 0);
+}
+
+void testClockClamped()
+{
+    MotorProfile p;
+    p.setDefaults();
+    MotorProfile out = roundTrip(p, [](Preferences &r) {
+        r.putUInt("m0_cpr", 4000000000u);
+        r.putUInt("m0_max", 0);
+    });
+    CHECK(out.clockPerRev == SLIP_CLOCK_REV_MAX);
+    CHECK(out.maxClockHz == CLOCK_CAP_MIN_HZ);
+    CHECK(out.startHz <= CLOCK_CAP_MIN_HZ);
+
+    out = roundTrip(p, [](Preferences &r) { r.putUInt("m0_max", 4000000000u); });
+    CHECK(out.maxClockHz == ClockSolver::HW_MAX_HZ);
+
+    // The ceiling follows the backend.
+    p.pulseBackend = PULSE_RMT;
+    out = roundTrip(p, [](Preferences &r) { r.putUInt("m0_max", ClockSolver::HW_MAX_HZ); });
+    CHECK(out.maxClockHz == RmtPulseEngine::MAX_HZ);
+}
+
+// Skip bands come back sorted and disjoint; empty and inverted ones go.
+void testSkipBandsRepaired()
+{
+    MotorProfile p;
+    p.setDefaults();
+    MotorProfile out = roundTrip(p, [](Preferences &r) {
+        SkipBand b[SKIP_MAX_BANDS] = {{5000, 6000}, {3000, 2000}, {1000, 1500}};
+        r.putBytes("m0_skb", b, sizeof(b));
+    });
+    CHECK(skipBandCount(out.skip) == 2);
+    CHECK(out.skip[0].loHz == 1000 && out.skip[0].hiHz == 1500);
+    CHECK(out.skip[1].loHz == 5000 && out.skip[1].hiHz == 6000);
+
+    out = roundTrip(p, [](Preferences &r) {
+        SkipBand b[SKIP_MAX_BANDS] = {{1800, 2500}, {1000, 2000}, {4000, 4000}};
+        r.putBytes("m0_skb", b, sizeof(b));
+    });
+    CHECK(skipBandCount(out.skip) == 1);
+    CHECK(out.skip[0].loHz == 1000 && out.skip[0].hiHz == 2500);
+
+    // Bands already in order are kept as they are.
+    p.skip[0] = {800, 900};
+    p.skip[1] = {2000, 2400};
+    out = roundTrip(p, [](Preferences &) {});
+    CHECK(skipBandCount(out.skip) == 2);
+    CHECK(out.skip[0].loHz == 800 && out.skip[0].hiHz == 900);
+    CHECK(out.skip[1].loHz == 2000 && out.skip[1].hiHz == 2400);
+}
+
+} // namespace
+
+int main()
+{
+    testInRangeUntouched();
+    testEnumsFallBack();
+    testLongNameTerminated();
+    testRatesClamped();
+    testStartHzClamped();
+    testPprZero();
+    testGainsClamped();
+    testClockClamped();
+    testSkipBandsRepaired();
+    return checkExit("test_profiles");
+}
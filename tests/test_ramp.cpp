@@ -0,0 +1,295 @@
+// SCurveRamp: monotonic approach, acceleration and jerk within their
+// limits, and arrival at the analytic S-curve time, for a fixed target and
+// for one raised or lowered mid-ramp; and the same trajectory when the
+// steps come at irregular intervals.
+#include "Check.h"
+#include "Config.h"
+#include "Ramp.h"
+
+namespace
+{
+
+// Time (s) for an S-curve to cover 'dv' Hz starting at acceleration 'a0'
+// (0 <= a0 <= aMax, toward the target) and ending at zero acceleration,
+// under an acceleration limit 'aMax' and a jerk limit 'j'.
+double sCurveTime(double dv, double a0, double aMax, double j)
+{
+    if (j == 0)
+        return dv / aMax;
+    // Full profile: a0 -> aMax, cruise at aMax, aMax -> 0.
+    double full = (2 * aMax * aMax - a0 * a0) / (2 * j);
+    if (dv >= full)
+        return (aMax - a0) / j + (dv - full) / aMax + aMax / j;
+    // Peak acceleration never reaches aMax: a0 -> ap -> 0.
+    double ap = sqrt((2 * j * dv + a0 * a0) / 2);
+    return (ap - a0) / j + ap / j;
+}
+
+// Same, for a target behind the motion: the acceleration a0 (away from
+// the target) is unwound first, which carries the speed a0^2/2J further.
+double sCurveTimeReversing(double dv, double a0, double aMax, double j)
+{
+    return a0 / j + sCurveTime(dv + a0 * a0 / (2 * j), 0, aMax, j);
+}
+
+struct Trace
+{
+    uint32_t ms;          // Steps until settled (1 ms each)
+    bool     monotonic;   // Hz never moved away from the target
+    int32_t  maxAccel;    // Largest |accelHzS()|
+    int64_t  maxJerk;     // Largest |change of accelHzS()| per second
+    int64_t  maxStepHz;   // Largest |Hz change| in one step
+};
+
+// Step 'r' at 1 ms toward 'target' until it settles (or 'maxMs').
+Trace run(SCurveRamp &r, uint32_t target, uint32_t maxMs)
+{
+    Trace t = {0, true, 0, 0, 0};
+    uint32_t prev = r.hz();
+    int32_t prevA = r.accelHzS();
+    bool up = target > prev;
+    while (t.ms < maxMs && !r.settled(target))
+    {
+        uint32_t hz = r.step(target, 1000);
+        int32_t a = r.accelHzS();
+        t.ms++;
+        if (up ? hz < prev : hz > prev)
+            t.monotonic = false;
+        int32_t absA = a < 0 ? -a : a;
+        if (absA > t.maxAccel)
+            t.maxAccel = absA;
+        int64_t jerk = (int64_t)(a - prevA) * 1000;
+        if (jerk < 0) jerk = -jerk;
+        if (jerk > t.maxJerk)
+            t.maxJerk = jerk;
+        int64_t d = (int64_t)hz - prev;
+        if (d < 0) d = -d;
+        if (d > t.maxStepHz)
+            t.maxStepHz = d;
+        prev = hz;
+        prevA = a;
+    }
+    return t;
+}
+
+// Arrival within a couple of steps of the continuous profile.
+void checkTime(uint32_t ms, double expectS)
+{
+    CHECK_NEAR(ms, expectS * 1000, 3 + expectS * 1000 * 0.005);
+}
+
+void testFixedTarget()
+{
+    struct Case { uint32_t accel, decel, jerk, from, to; };
+    const Case cases[] = {
+        {RAMP_ACCEL_HZ_S, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2, 50, 20000},   // Reaches the accel limit
+        {RAMP_ACCEL_HZ_S, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2, 20000, 50},   // Same, slowing down
+        {RAMP_ACCEL_HZ_S, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2, 1000, 1150},  // Triangular accel
+        {10000, 1000, 50000, 0, 40000},                                   // Asymmetric limits
+        {10000, 1000, 50000, 40000, 100},
+        {5000, 5000, 0, 100, 10100},                                      // No jerk limit
+    };
+    for (const Case &c : cases)
+    {
+        SCurveRamp r;
+        r.configure(c.accel, c.decel, c.jerk);
+        r.reset(c.from);
+        bool up = c.to > c.from;
+        uint32_t aMax = up ? c.accel : c.decel;
+        uint32_t dv = up ? c.to - c.from : c.from - c.to;
+
+        Trace t = run(r, c.to, 600000);
+        CHECK(r.settled(c.to));
+        CHECK(r.hz() == c.to);
+        CHECK(t.monotonic);
+        CHECK(t.maxAccel <= (int32_t)aMax);
+        // One step never moves further than the acceleration allows.
+        CHECK(t.maxStepHz <= aMax / 1000 + 1);
+        if (c.jerk)
+            CHECK(t.maxJerk <= (int64_t)c.jerk + 1000);
+        checkTime(t.ms, sCurveTime(dv, 0, aMax, c.jerk));
+    }
+}
+
+// Raised before the planner started braking: the trajectory goes on as if
+// the higher target had been set from the start.
+void testRaisedMidRamp()
+{
+    SCurveRamp r;
+    r.configure(RAMP_ACCEL_HZ_S, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2);
+    r.reset(0);
+    for (int i = 0; i < 300; i++)
+        r.step(10000, 1000);
+    CHECK(r.accelHzS() == RAMP_ACCEL_HZ_S);   // Still cruising at the limit
+
+    Trace t = run(r, 16000, 600000);
+    CHECK(r.settled(16000));
+    CHECK(t.monotonic);
+    CHECK(t.maxAccel <= RAMP_ACCEL_HZ_S);
+    CHECK(t.maxJerk <= RAMP_JERK_HZ_S2 + 1000);
+    checkTime(300 + t.ms, sCurveTime(16000, 0, RAMP_ACCEL_HZ_S, RAMP_JERK_HZ_S2));
+
+    // Raised while the acceleration is still building up.
+    r.reset(1000);
+    for (int i = 0; i < 40; i++)
+        r.step(1500, 1000);
+    double a0 = r.accelHzS();
+    double v0 = r.hz();
+    CHECK(a0 > 0 && a0 < RAMP_ACCEL_HZ_S);
+    t = run(r, 9000, 600000);
+    CHECK(r.settled(9000));
+    CHECK(t.monotonic);
+    CHECK(t.maxJerk <= RAMP_JERK_HZ_S2 + 1000);
+    checkTime(t.ms, sCurveTime(9000 - v0, a0, RAMP_ACCEL_HZ_S, RAMP_JERK_HZ_S2));
+}
+
+// Lowered mid-ramp, once still ahead of the current speed and once
+// behind it (the speed overshoots by a0^2/2J while the acceleration is
+// unwound, then comes back down).
+void testLoweredMidRamp()
+{
+    SCurveRamp r;
+    r.configure(RAMP_ACCEL_HZ_S, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2);
+
+    // Still ahead: the planner brakes early enough for the new target.
+    r.reset(0);
+    for (int i = 0; i < 300; i++)
+        r.step(20000, 1000);
+    double v0 = r.hz();
+    double a0 = r.accelHzS();
+    uint32_t target = (uint32_t)v0 + 2000;
+    Trace t = run(r, target, 600000);
+    CHECK(r.settled(target));
+    CHECK(t.monotonic);
+    CHECK(t.maxJerk <= RAMP_JERK_HZ_S2 + 1000);
+    checkTime(t.ms, sCurveTime(target - v0, a0, RAMP_ACCEL_HZ_S, RAMP_JERK_HZ_S2));
+
+    // Behind: unwind, turn around, decelerate. Jerk stays bounded and the
+    // way down is monotonic once the peak is passed.
+    r.reset(10000);
+    for (int i = 0; i < 300; i++)
+        r.step(20000, 1000);
+    v0 = r.hz();
+    a0 = r.accelHzS();
+    target = (uint32_t)v0 - 3000;
+
+    uint32_t ms = 0, peak = r.hz(), prev = r.hz();
+    int32_t prevA = r.accelHzS();
+    bool down = true;
+    int64_t maxJerk = 0;
+    bool turned = false;
+    while (ms < 600000 && !r.settled(target))
+    {
+        uint32_t hz = r.step(target, 1000);
+        int32_t a = r.accelHzS();
+        ms++;
+        if (hz > peak) peak = hz;
+        if (turned && hz > prev)
+            down = false;
+        if (hz < prev)
+            turned = true;
+        int64_t j = (int64_t)(a - prevA) * 1000;
+        if (j < 0) j = -j;
+        if (j > maxJerk) maxJerk = j;
+        CHECK(a >= -(int32_t)RAMP_DECEL_HZ_S && a <= (int32_t)RAMP_ACCEL_HZ_S);
+        prev = hz;
+        prevA = a;
+    }
+    CHECK(r.settled(target));
+    CHECK(down);
+    CHECK(maxJerk <= RAMP_JERK_HZ_S2 + 1000);
+    CHECK_NEAR(peak, v0 + a0 * a0 / (2.0 * RAMP_JERK_HZ_S2), 3);
+    checkTime(ms, sCurveTimeReversing(v0 - target, a0, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2));
+}
+
+// Motion ticks land 0.5..3 ms apart: the ramp integrates the real time of
+// each step, so it reaches the same Hz at about the same time as with a
+// steady 1 ms tick. The brake is planned as if the coming steps were as
+// long as the current one, so with uneven steps it may land with some
+// acceleration left (dropped once on the target); the jerk limit holds on
+// every other step.
+void testJitteredSteps()
+{
+    struct Case { uint32_t accel, decel, jerk, from, to; };
+    const Case cases[] = {
+        {RAMP_ACCEL_HZ_S, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2, 50, 20000},
+        {RAMP_ACCEL_HZ_S, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2, 20000, 50},
+        {RAMP_ACCEL_HZ_S, RAMP_DECEL_HZ_S, RAMP_JERK_HZ_S2, 1000, 1150},
+        {10000, 1000, 50000, 0, 40000},
+        {10000, 1000, 50000, 40000, 100},
+        {5000, 5000, 0, 100, 10100},
+    };
+    const uint32_t DT_MIN = 500, DT_MAX = 3000;
+    static uint32_t refHz[60000];
+    for (const Case &c : cases)
+    {
+        // Reference: Hz after every whole ms.
+        SCurveRamp ref;
+        ref.configure(c.accel, c.decel, c.jerk);
+        ref.reset(c.from);
+        uint32_t refMs = 0;
+        refHz[0] = c.from;
+        while (!ref.settled(c.to) && refMs + 1 < 60000)
+            refHz[++refMs] = ref.step(c.to, 1000);
+        CHECK(ref.settled(c.to));
+
+        uint32_t aMax = c.to > c.from ? c.accel : c.decel;
+        for (uint32_t seed = 1; seed <= 20; seed++)
+        {
+            uint32_t rnd = seed * 7919;
+            SCurveRamp r;
+            r.configure(c.accel, c.decel, c.jerk);
+            r.reset(c.from);
+            uint64_t us = 0;
+            uint32_t maxOff = 0;
+            int32_t prevA = 0;
+            int64_t maxJerk = 0;
+            while (!r.settled(c.to) && us < 120000000ULL)
+            {
+                rnd = rnd * 1664525u + 1013904223u;
+                uint32_t dt = DT_MIN + (rnd >> 8) % (DT_MAX - DT_MIN + 1);
+                uint32_t hz = r.step(c.to, dt);
+                us += dt;
+
+                // Against the reference at the nearest whole ms.
+                uint32_t ms = (uint32_t)((us + 500) / 1000);
+                uint32_t want = ms <= refMs ? refHz[ms] : c.to;
+                uint32_t off = hz > want ? hz - want : want - hz;
+                if (off > maxOff)
+                    maxOff = off;
+
+                int32_t a = r.accelHzS();
+                if (r.settled(c.to))
+                {
+                    // Acceleration left at landing: a few long steps' worth.
+                    if (c.jerk)
+                        CHECK(abs(prevA) <= (int64_t)c.jerk * DT_MAX * 5 / 1000000);
+                    break;
+                }
+                // Whole-Hz/s readings add up to 2 Hz/s of rounding.
+                int64_t j = (int64_t)(abs(a - prevA) - 2) * 1000000 / dt;
+                if (j > maxJerk)
+                    maxJerk = j;
+                prevA = a;
+            }
+            CHECK(r.settled(c.to));
+            CHECK(r.hz() == c.to);
+            CHECK_NEAR(us / 1000.0, refMs, 4 * DT_MAX / 1000 + refMs * 0.001);
+            // Along the way: off by at most what a couple of long steps move.
+            CHECK(maxOff <= aMax * DT_MAX * 2 / 1000000 + 2);
+            if (c.jerk)
+                CHECK(maxJerk <= (int64_t)c.jerk);
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testFixedTarget();
+    testRaisedMidRamp();
+    testLoweredMidRamp();
+    testJitteredSteps();
+    return checkExit("test_ramp");
+}
@@ -0,0 +1,188 @@
+// Direction reversal of a running motor (MotorRuntime::stepReversal()):
+// ramp down to REVERSAL_HZ, pause the clock, flip DIR once the last edge
+// is DIR_HOLD_US behind, resume DIR_SETUP_US later and ramp back up. DIR
+// must never change while the clock runs, and further reverse requests
+// during the sequence fold into it.
+#include "Check.h"
+#include "HostSim.h"
+#include "Motor.h"
+
+namespace
+{
+
+const uint32_t RUN_HZ = 2000;
+
+MotorProfile profile(PulseBackend backend)
+{
+    MotorProfile p;
+    p.setDefaults();
+    p.pulseBackend = backend;
+    p.accelHzS     = 5000;
+    p.decelHzS     = 5000;
+    return p;
+}
+
+// What the test saw tick by tick.
+struct Timeline
+{
+    uint32_t pauses = 0;          // Clock went from running to 0
+    uint32_t resumes = 0;         // ... and back
+    bool     monotonic = true;    // Down until the pause, up after it
+    int64_t  pausedUs = -1;       // Tick that saw the last pause
+    int64_t  resumedUs = -1;      // Tick that saw the last resume
+    uint32_t minHz = UINT32_MAX;  // Lowest non-zero Hz
+};
+
+void tickFor(MotorRuntime &m, uint32_t ms, Timeline &t)
+{
+    uint32_t prev = m.currentHz;
+    for (uint32_t i = 0; i < ms; i++)
+    {
+        host::advanceMs(1);
+        uint32_t hz = m.currentHz;
+        if (prev > 0 && hz == 0)
+        {
+            t.pauses++;
+            t.pausedUs = host::nowUs();
+        }
+        else if (prev == 0 && hz > 0)
+        {
+            t.resumes++;
+            t.resumedUs = host::nowUs();
+        }
+        else if (hz > 0 && (t.pauses == 0 ? hz > prev : hz < prev))
+        {
+            t.monotonic = false;   // Up before the pause, or down after it
+        }
+        if (hz > 0 && hz < t.minHz)
+            t.minHz = hz;
+        prev = hz;
+    }
+}
+
+// DIR level changes since 'from' (index into pinWrites()); every one must
+// come with the clock off and DIR_HOLD_US after the last edge.
+uint32_t dirEdges(size_t from, uint8_t &level, bool rmt)
+{
+    uint32_t n = 0;
+    const std::vector<host::PinWrite> &w = host::pinWrites();
+    for (size_t i = from; i < w.size(); i++)
+    {
+        if (w[i].pin != PIN_DIR || w[i].level == level)
+            continue;
+        level = w[i].level;
+        n++;
+        CHECK(!w[i].clockOn);
+        if (rmt)
+        {
+            CHECK(w[i].atUs - w[i].rmtLastEdgeUs >= DIR_HOLD_US);
+        }
+        else
+        {
+            CHECK(w[i].clockOffHz > 0);
+            int64_t lastEdgeEnd = w[i].clockOffUs + 1000000 / w[i].clockOffHz;
+            CHECK(w[i].atUs - lastEdgeEnd >= DIR_HOLD_US);
+        }
+    }
+    return n;
+}
+
+// Start at RUN_HZ; returns the index in pinWrites() to watch from.
+size_t startRunning(MotorRuntime &m, PulseBackend backend, uint8_t &dirLevel)
+{
+    host::reset();
+    m.begin();
+    m.applyProfile(profile(backend));
+    m.setTargetHz(RUN_HZ);
+    m.start();
+    Timeline warm;
+    tickFor(m, 1500, warm);
+    CHECK(m.currentHz == RUN_HZ);
+    dirLevel = (uint8_t)host::pinLevel(PIN_DIR);
+    return host::pinWrites().size();
+}
+
+void testTimeline(PulseBackend backend)
+{
+    MotorRuntime m;
+    uint8_t level;
+    size_t from = startRunning(m, backend, level);
+    uint8_t before = level;
+
+    m.setDirCW(false);
+    Timeline t;
+    tickFor(m, 2000, t);
+    CHECK(t.pauses == 1 && t.resumes == 1);
+    CHECK(t.monotonic);
+    CHECK(t.minHz <= REVERSAL_HZ);
+    CHECK(m.currentHz == RUN_HZ);
+    CHECK(dirEdges(from, level, backend == PULSE_RMT) == 1);
+    CHECK(level != before);
+
+    // DIR went out while paused, and the clock came back after the setup.
+    const std::vector<host::PinWrite> &w = host::pinWrites();
+    int64_t dirUs = -1;
+    for (size_t i = from; i < w.size(); i++)
+        if (w[i].pin == PIN_DIR && w[i].level == level)
+            dirUs = w[i].atUs;
+    CHECK(dirUs >= t.pausedUs);
+    CHECK(t.resumedUs - dirUs >= DIR_SETUP_US);
+}
+
+// The same direction requested again during the decel: one pause, one flip.
+void testRepeatedRequest()
+{
+    MotorRuntime m;
+    uint8_t level;
+    size_t from = startRunning(m, PULSE_LEDC, level);
+
+    m.setDirCW(false);
+    Timeline t;
+    tickFor(m, 50, t);
+    CHECK(m.currentHz > REVERSAL_HZ && m.currentHz < RUN_HZ);
+    m.setDirCW(false);
+    tickFor(m, 50, t);
+    m.setDirCW(true);
+    m.setDirCW(false);
+    tickFor(m, 2000, t);
+    CHECK(t.pauses == 1 && t.resumes == 1);
+    CHECK(t.monotonic);
+    CHECK(dirEdges(from, level, false) == 1);
+    CHECK(m.currentHz == RUN_HZ);
+}
+
+// Turned back during the decel: the pause still runs, DIR does not move.
+void testTurnedBack()
+{
+    MotorRuntime m;
+    uint8_t level;
+    size_t from = startRunning(m, PULSE_LEDC, level);
+    uint8_t before = level;
+
+    m.setDirCW(false);
+    Timeline t;
+    tickFor(m, 100, t);
+    m.setDirCW(true);
+    tickFor(m, 2000, t);
+    CHECK(t.pauses == 1 && t.resumes == 1);
+    CHECK(dirEdges(from, level, false) == 0);
+    CHECK(level == before);
+    CHECK(m.currentHz == RUN_HZ);
+
+    // And a real reversal afterwards still works.
+    m.setDirCW(false);
+    tickFor(m, 2000, t);
+    CHECK(t.pauses == 2);
+    CHECK(dirEdges(from, level, false) == 1);
+}
+
+} // namespace
+
+int main()
+{
+    testTimeline(PULSE_LEDC);
+    testTimeline(PULSE_RMT);
+    testRepeatedRequest();
+    testTurnedBack();
+    return checkExit("test_reversal");
+}
@@ -0,0 +1,215 @@
+// RpmFilter stages on a step with impulse noise (tenths of RPM). Checks
+// that the median removes isolated spikes completely, that each stage and
+// the full chain lag the step by the expected number of samples, and that
+// every stage starts on the first sample without a dip.
+#include "Check.h"
+#include "Config.h"
+#include "RpmFilter.h"
+#include <math.h>
+
+namespace
+{
+
+const uint32_t LO = 10000;   // 1000.0 RPM
+const uint32_t HI = 15000;   // 1500.0 RPM
+const int      LEN = 200;    // Samples per run; the step comes at STEP_AT
+const int      STEP_AT = 50;
+
+// Raw RPM: LO, then HI from STEP_AT on. With 'spikeEvery', every
+// spikeEvery-th sample is a dropout (0) or a burst (3x), alternately.
+void makeInput(uint32_t *x, int spikeEvery)
+{
+    for (int i = 0; i < LEN; i++)
+    {
+        x[i] = i < STEP_AT ? LO : HI;
+        if (spikeEvery && i % spikeEvery == spikeEvery / 2)
+            x[i] = (i / spikeEvery) % 2 ? 0 : x[i] * 3;
+    }
+}
+
+void run(RpmFilter &f, const uint32_t *x, uint32_t *y)
+{
+    f.reset();
+    for (int i = 0; i < LEN; i++)
+        y[i] = f.update(x[i]);
+}
+
+// Samples after the step until the output first reaches 'frac' of it.
+int lagTo(const uint32_t *y, double frac)
+{
+    double level = LO + (HI - LO) * frac;
+    for (int i = STEP_AT; i < LEN; i++)
+        if (y[i] >= level - 0.5)
+            return i - STEP_AT;
+    return LEN;
+}
+
+// Median of N: the output is exactly the input delayed by N - N/2 - 1
+// samples (the sorted middle flips once the new level holds the majority).
+void testMedianStep()
+{
+    static const uint8_t ns[] = {1, 3, 4, 5, 9, 15};
+    uint32_t x[LEN], y[LEN];
+    makeInput(x, 0);
+    for (uint8_t n : ns)
+    {
+        RpmFilter f;
+        f.configure(RPM_FILT_MEDIAN, n, 1, 255);
+        run(f, x, y);
+        int lag = n - n / 2 - 1;
+        bool exact = true;
+        for (int i = 0; i < LEN; i++)
+            exact &= y[i] == (i < STEP_AT + lag ? LO : HI);
+        CHECK(exact);
+        CHECK(lagTo(y, 0.5) == lag);
+    }
+}
+
+// Median of N rejects any burst of up to (N-1)/2 outliers in a row, of
+// either sign, and a longer burst gets through.
+void testMedianOutliers()
+{
+    static const uint8_t ns[] = {3, 5, 7, 15};
+    for (uint8_t n : ns)
+    {
+        int burst = (n - 1) / 2;
+        for (int len = 1; len <= burst + 1; len++)
+        {
+            RpmFilter f;
+            f.configure(RPM_FILT_MEDIAN, n, 1, 255);
+            uint32_t maxDev = 0;
+            for (int i = 0; i < 3 * n + len; i++)
+            {
+                bool spike = i >= 2 * n && i < 2 * n + len;
+                uint32_t in = spike ? (len % 2 ? 0 : 10 * LO) : LO;
+                uint32_t out = f.update(in);
+                uint32_t dev = out > LO ? out - LO : LO - out;
+                if (dev > maxDev) maxDev = dev;
+            }
+            if (len <= burst)
+                CHECK(maxDev == 0);
+            else
+                CHECK(maxDev == LO * (len % 2 ? 1 : 9));
+        }
+    }
+}
+
+// Moving average of N: a straight ramp over N samples, reaching the new
+// level N - 1 samples after the step.
+void testAverageStep()
+{
+    static const uint8_t ns[] = {1, 2, 4, 8, 15};
+    uint32_t x[LEN], y[LEN];
+    makeInput(x, 0);
+    for (uint8_t n : ns)
+    {
+        RpmFilter f;
+        f.configure(RPM_FILT_AVG, 1, n, 255);
+        run(f, x, y);
+        bool exact = true;
+        for (int k = 0; k < 2 * n; k++)
+        {
+            int inNew = k + 1 < n ? k + 1 : n;
+            double want = LO + (double)(HI - LO) * inNew / n;
+            exact &= fabs(y[STEP_AT + k] - want) <= 0.5;
+        }
+        CHECK(exact);
+        CHECK(lagTo(y, 1.0) == n - 1);
+        CHECK(lagTo(y, 0.5) == (n + 1) / 2 - 1);
+    }
+}
+
+// IIR with weight a = alpha/256: after k + 1 samples the output is
+// 1 - (1 - a)^(k+1) of the way. Q8 truncation may leave it a little short.
+void testIirStep()
+{
+    static const uint8_t alphas[] = {16, 64, 128, 255};
+    uint32_t x[LEN], y[LEN];
+    makeInput(x, 0);
+    for (uint8_t al : alphas)
+    {
+        RpmFilter f;
+        f.configure(RPM_FILT_IIR, 1, 1, al);
+        run(f, x, y);
+        double a = al / 256.0;
+        double worst = 0;
+        for (int k = 0; STEP_AT + k < LEN; k++)
+        {
+            double want = HI - (HI - LO) * pow(1 - a, k + 1);
+            double err = want - y[STEP_AT + k];
+            if (fabs(err) > fabs(worst)) worst = err;
+        }
+        CHECK_NEAR(worst, 0, 1.0);
+        int lag = (int)ceil(log(0.5) / log(1 - a)) - 1;
+        CHECK_NEAR(lagTo(y, 0.5), lag, 1);
+    }
+}
+
+// Median 5 -> average 4 -> IIR 64 on the step with a spike every 10
+// samples: the median strips the spikes, so the output is the same as
+// without them, and the lags add up. (A spike inside the median window
+// of the step itself would move the edge by a sample, so none falls
+// there.) Without the median the spikes leak into the average.
+void testChain()
+{
+    uint32_t clean[LEN], noisy[LEN], y0[LEN], y1[LEN];
+    makeInput(clean, 0);
+    makeInput(noisy, 10);
+
+    RpmFilter f;
+    f.configure(RPM_FILT_MEDIAN | RPM_FILT_AVG | RPM_FILT_IIR, 5, 4, 64);
+    run(f, clean, y0);
+    run(f, noisy, y1);
+    bool same = true;
+    for (int i = 0; i < LEN; i++)
+        same &= y0[i] == y1[i];
+    CHECK(same);
+    CHECK(y0[LEN - 1] >= HI - 1 && y0[LEN - 1] <= HI);
+
+    // Median delays by 2, the average is half way 1 sample later, and the
+    // IIR (a = 1/4) trails the average's ramp by 3 more.
+    int lag = lagTo(y0, 0.5);
+    CHECK(lag == 2 + 1 + 3);
+    CHECK(lagTo(y0, 0.95) > lag);
+
+    RpmFilter g;
+    g.configure(RPM_FILT_AVG | RPM_FILT_IIR, 5, 4, 64);
+    run(g, clean, y0);
+    run(g, noisy, y1);
+    uint32_t leak = 0;
+    for (int i = 0; i < LEN; i++)
+    {
+        uint32_t d = y0[i] > y1[i] ? y0[i] - y1[i] : y1[i] - y0[i];
+        if (d > leak) leak = d;
+    }
+    CHECK(leak > (HI - LO) / 10);
+}
+
+// Every configuration passes the first sample straight through, and
+// reset() starts over from the next one.
+void testStart()
+{
+    for (uint8_t m = 0; m <= (RPM_FILT_MEDIAN | RPM_FILT_AVG | RPM_FILT_IIR); m++)
+    {
+        RpmFilter f;
+        f.configure(m, 5, 4, 64);
+        CHECK(f.active() == (m != 0));
+        CHECK(f.update(LO) == LO);
+        f.update(HI);
+        f.reset();
+        CHECK(f.update(HI) == HI);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testMedianStep();
+    testMedianOutliers();
+    testAverageStep();
+    testIirStep();
+    testChain();
+    testStart();
+    return checkExit("test_rpm_filter");
+}
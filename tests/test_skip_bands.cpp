@@ -0,0 +1,257 @@
+// Resonance skip bands: bands from a sweep curve at its ends and at the
+// pull-out point, the ramp crossing a band instead of dwelling in it, and
+// live detection from the FG period spread. Built twice: as is
+// (SKIP_LIVE_DETECT 0, nothing is learned while running) and as
+// test_skip_bands_live with SKIP_LIVE_DETECT 1.
+#include "Check.h"
+#include "HostSim.h"
+#include "Motor.h"
+
+namespace
+{
+
+// A flat curve of SWEEP_POINTS steps 'stepHz' apart from 'firstHz', 1%
+// ripple, with 20% ripple on steps [from, to].
+SweepCurve curve(uint32_t firstHz, uint32_t stepHz, uint8_t from, uint8_t to)
+{
+    SweepCurve c = {};
+    c.version = SWEEP_CURVE_VERSION;
+    c.count   = SWEEP_POINTS;
+    c.pullOut = SWEEP_NONE;
+    for (uint8_t i = 0; i < SWEEP_POINTS; i++)
+    {
+        c.pt[i].hz        = firstHz + i * stepHz;
+        c.pt[i].rpm       = 1000;
+        c.pt[i].rippleX10 = (i >= from && i <= to) ? 2000 : 100;
+    }
+    return c;
+}
+
+void testFromCurve()
+{
+    SkipBand b[SKIP_MAX_BANDS];
+
+    // Starting at step 0: half a step below it, but not below 0 Hz.
+    CHECK(skipBandsFromCurve(curve(1000, 300, 0, 0), b) == 1);
+    CHECK(b[0].loHz == 850 && b[0].hiHz == 1150);
+    CHECK(skipBandsFromCurve(curve(100, 300, 0, 1), b) == 1);
+    CHECK(b[0].loHz == 0 && b[0].hiHz == 550);
+
+    // Ending at the last step: half a step above it.
+    const uint8_t last = SWEEP_POINTS - 1;
+    CHECK(skipBandsFromCurve(curve(1000, 300, last - 1, last), b) == 1);
+    CHECK(b[0].loHz == 1000 + 300 * (last - 1) - 150);
+    CHECK(b[0].hiHz == 1000 + 300 * last + 150);
+
+    // In the middle: halfway to the neighbours.
+    CHECK(skipBandsFromCurve(curve(1000, 300, 5, 6), b) == 1);
+    CHECK(b[0].loHz == 2350 && b[0].hiHz == 2950);
+
+    // Pull-out: steps from it on are ignored, and a band running into it
+    // ends half a step past the last step before it.
+    SweepCurve c = curve(1000, 300, 9, 11);
+    c.pullOut = 10;
+    CHECK(skipBandsFromCurve(c, b) == 1);
+    CHECK(b[0].loHz == 1000 + 300 * 9 - 150 && b[0].hiHz == 1000 + 300 * 9 + 150);
+    c = curve(1000, 300, 10, 12);
+    c.pullOut = 10;
+    CHECK(skipBandsFromCurve(c, b) == 0);
+    c.pullOut = 2;                          // Too few steps to judge
+    CHECK(skipBandsFromCurve(c, b) == 0);
+
+    // Noisy throughout: nothing stands out.
+    CHECK(skipBandsFromCurve(curve(1000, 300, 0, last), b) == 0);
+}
+
+void testExit()
+{
+    SkipBand b[SKIP_MAX_BANDS];
+    skipBandsClear(b);
+    CHECK(skipBandAdd(b, 1000, 2000));
+    CHECK(skipBandExit(b, 1500, 3000) == 2000);   // Up through it
+    CHECK(skipBandExit(b, 1500, 0) == 1000);      // Down through it
+    CHECK(skipBandExit(b, 1500, 1800) == 1500);   // Target inside: stay
+    CHECK(skipBandExit(b, 1000, 3000) == 1000);   // Edges are outside
+    CHECK(skipBandExit(b, 900, 3000) == 900);
+    CHECK(skipBandAdjust(b, 1400, 1) == 2000);
+    CHECK(skipBandAdjust(b, 1400, -1) == 1000);
+    CHECK(skipBandAdjust(b, 1400, 0) == 1000);    // Nearer edge
+}
+
+MotorProfile ledcProfile()
+{
+    MotorProfile p;
+    p.setDefaults();
+    p.startHz  = 100;
+    p.accelHzS = 2000;
+    p.decelHzS = 2000;
+    return p;
+}
+
+// Tick until the clock settles on 'hz' (or 'ms' pass); false if the clock
+// is ever strictly inside a band on the way.
+bool rampTo(MotorRuntime &m, uint32_t hz, uint32_t ms)
+{
+    bool outside = true;
+    for (uint32_t i = 0; i < ms; i++)
+    {
+        host::advanceMs(1);
+        uint32_t now = m.currentHz;
+        for (uint8_t k = 0; k < SKIP_MAX_BANDS; k++)
+            if (skipBandUsed(m.skipBands()[k]) && now > m.skipBands()[k].loHz &&
+                now < m.skipBands()[k].hiHz)
+                outside = false;
+        if (now == hz && m.currentHz == m.targetHz && i > 10)
+            break;
+    }
+    return outside;
+}
+
+// The ramp jumps across a band both ways and a ramped stop does too;
+// setpoints inside one move to an edge (skipTarget()).
+void testRamp()
+{
+    host::reset();
+    MotorRuntime m;
+    m.begin();
+    MotorProfile p = ledcProfile();
+    p.skip[0] = {1000, 2000};
+    m.applyProfile(p);
+
+    m.setTargetHz(3000);
+    m.start();
+    CHECK(rampTo(m, 3000, 5000));
+    CHECK(m.currentHz == 3000);
+
+    m.setTargetHz(1500);                  // Inside, coming down: lower edge
+    CHECK(m.targetHz == 1000);
+    CHECK(rampTo(m, 1000, 5000));
+    CHECK(m.currentHz == 1000);
+
+    m.setTargetHz(1200);                  // Inside, going up: upper edge
+    CHECK(m.targetHz == 2000);
+    CHECK(rampTo(m, 2000, 5000));
+    CHECK(m.currentHz == 2000);
+
+    m.stop();                             // Ramped stop through [1000, 2000]
+    CHECK(rampTo(m, 0, 5000));
+    CHECK(m.currentHz == 0);
+}
+
+// A motor whose FG follows the clock (0.25 edges/s per Hz), with a period
+// that alternates 0.6 T / 1.4 T while 'resonant' (80% spread).
+struct Fg
+{
+    bool    resonant = true;
+    bool    longNext = false;
+    int64_t nextUs   = 0;
+
+    void run(MotorRuntime &m, uint32_t ms)
+    {
+        int64_t end = host::nowUs() + (int64_t)ms * 1000;
+        int64_t nextMs = host::nowUs() + 1000;
+        while (host::nowUs() < end)
+        {
+            uint32_t hz = m.currentHz;
+            if (hz == 0)
+                nextUs = 0;
+            else if (nextUs == 0)
+                nextUs = host::nowUs() + 4000000LL / hz;
+            int64_t to = (nextUs && nextUs < nextMs) ? nextUs : nextMs;
+            host::advanceUs(to - host::nowUs());
+            if (nextUs && host::nowUs() >= nextUs)
+            {
+                host::interrupt(PIN_FG);
+                int64_t t = 4000000LL / (hz ? hz : 1);
+                if (resonant)
+                    t = longNext ? t * 14 / 10 : t * 6 / 10;
+                longNext = !longNext;
+                nextUs += t;
+            }
+            if (host::nowUs() >= nextMs)
+            {
+                m.sampleRPM();                // loop()
+                nextMs += 1000;
+            }
+        }
+    }
+};
+
+void fgMotor(MotorRuntime &m)
+{
+    host::reset();
+    m.begin();
+    MotorProfile p = ledcProfile();
+    p.hasFG = true;
+    p.ppr   = 4;
+    m.applyProfile(p);
+    m.setTargetHz(800);
+    m.start();
+}
+
+// A steady FG never adds a band, whatever the build.
+void testLiveSteady()
+{
+    MotorRuntime m;
+    fgMotor(m);
+    Fg fg;
+    fg.resonant = false;
+    fg.run(m, 3 * SKIP_LIVE_MS);
+    CHECK(m.running);
+    CHECK(m.currentHz == 800);
+    CHECK(skipBandCount(m.skipBands()) == 0);
+}
+
+#if SKIP_LIVE_DETECT
+// A wide FG period spread held SKIP_LIVE_MS at a steady clock adds a band
+// of +/-SKIP_LIVE_BAND_PCT around it, and the target leaves for the
+// nearer edge. Once it is gone, nothing more is learned.
+void testLiveResonance()
+{
+    MotorRuntime m;
+    fgMotor(m);
+    Fg fg;
+    uint32_t ms = 0;
+    while (skipBandCount(m.skipBands()) == 0 && ms < 3 * SKIP_LIVE_MS)
+    {
+        fg.run(m, 10);
+        ms += 10;
+    }
+    fg.resonant = false;
+    CHECK(skipBandCount(m.skipBands()) == 1);
+    CHECK(ms >= SKIP_LIVE_MS && ms < SKIP_LIVE_MS + 1000);
+    CHECK(m.skipBands()[0].loHz == 800 - 800 * SKIP_LIVE_BAND_PCT / 100);
+    CHECK(m.skipBands()[0].hiHz == 800 + 800 * SKIP_LIVE_BAND_PCT / 100);
+    CHECK(m.targetHz == m.skipBands()[0].loHz);
+    CHECK(m.takeSkipBandsChanged());
+
+    fg.run(m, 3 * SKIP_LIVE_MS);
+    CHECK(m.running);
+    CHECK(m.currentHz == m.skipBands()[0].loHz);
+    CHECK(skipBandCount(m.skipBands()) == 1);
+}
+#else
+// Not learned in this build, however long the spread lasts.
+void testLiveResonance()
+{
+    MotorRuntime m;
+    fgMotor(m);
+    Fg fg;
+    fg.run(m, 3 * SKIP_LIVE_MS);
+    CHECK(m.running);
+    CHECK(skipBandCount(m.skipBands()) == 0);
+    CHECK(!m.takeSkipBandsChanged());
+}
+#endif
+
+} // namespace
+
+int main()
+{
+    testFromCurve();
+    testExit();
+    testRamp();
+    testLiveSteady();
+    testLiveResonance();
+    return checkExit(SKIP_LIVE_DETECT ? "test_skip_bands_live" : "test_skip_bands");
+}
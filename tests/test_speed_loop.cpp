@@ -0,0 +1,147 @@
+// SpeedPI against a first-order motor: RPM' = (K * Hz - RPM) / TAU, the
+// controller updated every RPM_MIN_WINDOW_MS with the measured RPM. Checks
+// settling time and overshoot against the continuous closed loop, and that
+// a saturated output does not wind the integrator up.
+#include "Check.h"
+#include "Config.h"
+#include "SpeedLoop.h"
+#include <math.h>
+
+namespace
+{
+
+const double   K   = 2.5;    // RPM per Hz of clock
+const double   TAU = 0.25;   // Mechanical time constant (s)
+const uint32_t DT_MS = RPM_MIN_WINDOW_MS;
+
+struct Plant
+{
+    double rpm = 0;
+    // Hold 'hz' for 'ms' (1 ms Euler steps).
+    void run(uint32_t hz, uint32_t ms)
+    {
+        for (uint32_t i = 0; i < ms; i++)
+            rpm += (K * hz - rpm) / TAU * 0.001;
+    }
+};
+
+struct Step
+{
+    double   peak;       // Furthest RPM past the target, in % of the step
+    double   settleS;    // Last time outside +-2% of the step (s)
+    uint32_t firstHz;    // Output of the first update
+    uint32_t finalHz;
+};
+
+// Step the target from the plant's current speed to 'target' and run 'ms'.
+Step stepTo(SpeedPI &pi, Plant &plant, double target, uint32_t ms, uint32_t minHz, uint32_t maxHz)
+{
+    Step s = {0, 0, 0, 0};
+    double from = plant.rpm;
+    double span = fabs(target - from);
+    double dir = target > from ? 1 : -1;
+    for (uint32_t t = 0; t < ms; t += DT_MS)
+    {
+        int32_t err = (int32_t)lround(target - plant.rpm);
+        uint32_t hz = pi.update(err, DT_MS, minHz, maxHz);
+        if (t == 0)
+            s.firstHz = hz;
+        s.finalHz = hz;
+        plant.run(hz, DT_MS);
+        double past = (plant.rpm - target) * dir / span * 100;
+        if (past > s.peak)
+            s.peak = past;
+        if (fabs(plant.rpm - target) > 0.02 * span)
+            s.settleS = (t + DT_MS) / 1000.0;
+    }
+    return s;
+}
+
+// Default gains: the loop closes to (2s+5)/((s+1)(s+5)), whose step
+// response 1 - 0.75e^-t - 0.25e^-5t has no overshoot and stays within 2%
+// after ln(37.5) = 3.62 s. The 50 ms sampling may shift that a little.
+void testDefaultGains()
+{
+    SpeedPI pi;
+    pi.configure(SPEED_KP_MILLI, SPEED_KI_MILLI);
+    Plant plant;
+    pi.reset(0);
+    Step s = stepTo(pi, plant, 1500, 15000, 0, 5000);
+    CHECK(s.peak < 1.0);
+    CHECK_NEAR(s.settleS, log(37.5), 0.3);
+    CHECK_NEAR(plant.rpm, 1500, 1);
+    CHECK_NEAR(s.finalHz, 1500 / K, 1);
+
+    // Down again: same dynamics.
+    s = stepTo(pi, plant, 500, 15000, 0, 5000);
+    CHECK(s.peak < 1.0);
+    CHECK_NEAR(s.settleS, log(37.5), 0.3);
+    CHECK_NEAR(plant.rpm, 500, 1);
+}
+
+// Faster gains (Kp 0.4, Ki 4): s^2 + 8s + 40, zeta = 0.63, plus the PI
+// zero at -10; the continuous loop overshoots by 10.4% and stays within
+// 2% after 0.84 s.
+void testFastGains()
+{
+    SpeedPI pi;
+    pi.configure(400, 4000);
+    Plant plant;
+    pi.reset(0);
+    Step s = stepTo(pi, plant, 2000, 10000, 0, 5000);
+    CHECK_NEAR(s.peak, 10.4, 2);
+    CHECK_NEAR(s.settleS, 0.84, 0.2);
+    CHECK_NEAR(plant.rpm, 2000, 1);
+}
+
+// Out of reach: the output sits on the clamp for a long time, yet once the
+// target comes back in range the loop leaves the clamp on the next update
+// and settles no slower than a step from rest, without overshoot. A wound
+// up integrator would hold the clamp for seconds and then overshoot.
+void testAntiWindup()
+{
+    const uint32_t MAX_HZ = 1000, MIN_HZ = 100;
+    SpeedPI pi;
+    pi.configure(SPEED_KP_MILLI, SPEED_KI_MILLI);
+    Plant plant;
+    pi.reset(0);
+
+    Step s = stepTo(pi, plant, 4000, 20000, MIN_HZ, MAX_HZ);   // K*MAX_HZ = 2500
+    CHECK(s.finalHz == MAX_HZ);
+    CHECK_NEAR(plant.rpm, K * MAX_HZ, 1);
+
+    s = stepTo(pi, plant, 1500, 15000, MIN_HZ, MAX_HZ);
+    CHECK(s.firstHz < MAX_HZ);           // Off the clamp on the first update
+    CHECK(s.peak < 1.0);
+    CHECK(s.settleS < log(37.5) + 0.3);
+    CHECK_NEAR(plant.rpm, 1500, 1);
+
+    // The same at the lower clamp.
+    s = stepTo(pi, plant, 50, 20000, MIN_HZ, MAX_HZ);          // K*MIN_HZ = 250
+    CHECK(s.finalHz == MIN_HZ);
+    s = stepTo(pi, plant, 1000, 15000, MIN_HZ, MAX_HZ);
+    CHECK(s.firstHz > MIN_HZ);
+    CHECK(s.peak < 1.0);
+    CHECK(s.settleS < log(37.5) + 0.3);
+    CHECK_NEAR(plant.rpm, 1000, 1);
+}
+
+// Bumpless engage: reset() at the running frequency, zero error, no jump.
+void testBumpless()
+{
+    SpeedPI pi;
+    pi.configure(SPEED_KP_MILLI, SPEED_KI_MILLI);
+    pi.reset(600);
+    CHECK(pi.update(0, DT_MS, 0, 5000) == 600);
+}
+
+} // namespace
+
+int main()
+{
+    testDefaultGains();
+    testFastGains();
+    testAntiWindup();
+    testBumpless();
+    return checkExit("test_speed_loop");
+}
@@ -0,0 +1,141 @@
+// SpscRing with a real producer and consumer thread: 10^7 sequence numbers
+// pushed through small rings. Each element carries its complement, so a slot
+// read before the producer finished it shows up. Checks that nothing is
+// lost, duplicated or reordered, and that the full / empty outcomes the two
+// sides saw agree with dropped() and size().
+#include "Check.h"
+#include "SpscRing.h"
+#include <thread>
+
+namespace
+{
+
+const uint32_t COUNT = 10000000;
+
+struct Item
+{
+    uint32_t seq;
+    uint32_t inv;   // ~seq
+};
+
+struct Result
+{
+    uint32_t received = 0;
+    uint32_t empties  = 0;     // pop() found nothing
+    uint32_t torn     = 0;     // inv != ~seq
+    uint32_t order    = 0;     // Not the sequence number expected
+    uint32_t maxSize  = 0;     // Largest size() seen by the consumer
+};
+
+// Producer retries a full ring, so every item must arrive, in order.
+template <uint32_t N>
+void testLossless()
+{
+    SpscRing<Item, N> ring;
+    uint32_t fulls = 0;
+    Result r;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < COUNT; i++)
+        {
+            while (!ring.push({i, ~i}))
+            {
+                fulls++;
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::thread consumer([&] {
+        Item it;
+        while (r.received < COUNT)
+        {
+            uint32_t sz = ring.size();
+            if (sz > r.maxSize) r.maxSize = sz;
+            if (!ring.pop(it))
+            {
+                r.empties++;
+                std::this_thread::yield();
+                continue;
+            }
+            if (it.inv != ~it.seq) r.torn++;
+            if (it.seq != r.received) r.order++;
+            r.received++;
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    printf("  N=%u lossless: %u full, %u empty\n", (unsigned)N, (unsigned)fulls, (unsigned)r.empties);
+    CHECK(r.received == COUNT);
+    CHECK(r.torn == 0);
+    CHECK(r.order == 0);
+    CHECK(r.maxSize <= N);
+    CHECK(ring.dropped() == fulls);          // Every refused push was counted
+    CHECK(ring.size() == 0);
+    Item it;
+    CHECK(!ring.pop(it));
+}
+
+// Producer pushes once and moves on, as the FG ISR does: what arrives is a
+// strictly increasing subsequence, and the gaps are exactly the drops.
+template <uint32_t N>
+void testLossy()
+{
+    SpscRing<Item, N> ring;
+    uint32_t refused = 0;
+    std::atomic<bool> done{false};
+    Result r;
+    uint32_t gaps = 0;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < COUNT; i++)
+            if (!ring.push({i, ~i}))
+                refused++;
+        done.store(true, std::memory_order_release);
+    });
+    std::thread consumer([&] {
+        Item it;
+        uint32_t next = 0;
+        for (;;)
+        {
+            bool finished = done.load(std::memory_order_acquire);
+            if (!ring.pop(it))
+            {
+                if (finished) break;    // Nothing more can arrive
+                r.empties++;
+                std::this_thread::yield();
+                continue;
+            }
+            if (it.inv != ~it.seq) r.torn++;
+            if (it.seq < next) r.order++;
+            else gaps += it.seq - next;
+            next = it.seq + 1;
+            r.received++;
+        }
+        gaps += COUNT - next;
+    });
+    producer.join();
+    consumer.join();
+
+    printf("  N=%u lossy: %u received, %u dropped, %u empty\n", (unsigned)N, (unsigned)r.received,
+           (unsigned)refused, (unsigned)r.empties);
+    CHECK(r.torn == 0);
+    CHECK(r.order == 0);
+    CHECK(ring.dropped() == refused);
+    CHECK(gaps == refused);
+    CHECK(r.received + refused == COUNT);
+    CHECK(r.received > 0);
+    CHECK(ring.size() == 0);
+}
+
+} // namespace
+
+int main()
+{
+    testLossless<4>();
+    testLossless<64>();
+    testLossless<1024>();
+    testLossy<16>();
+    testLossy<1024>();
+    return checkExit("test_spsc_ring");
+}
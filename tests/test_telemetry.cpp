@@ -0,0 +1,209 @@
+// Binary telemetry wire format and the host decoder (TelemetryFrame.h):
+// the CRC check value, COBS round trips (zeros, long runs), a record
+// round trip, and the decoder's version check, sequence gaps, wraps and
+// restarts.
+#include "Check.h"
+#include "TelemetryFrame.h"
+#include <string.h>
+
+namespace
+{
+
+// CRC-16/CCITT-FALSE check value: "123456789" -> 0x29B1.
+void testCrc()
+{
+    const char *s = "123456789";
+    CHECK(telemCrc16((const uint8_t *)s, strlen(s)) == 0x29B1);
+    CHECK(telemCrc16(nullptr, 0) == 0xFFFF);
+}
+
+// Encode, check no 0x00 is left and the size bound holds, decode back.
+bool cobsRoundTrip(const uint8_t *in, size_t n)
+{
+    static uint8_t enc[2048], dec[2048];
+    size_t e = telemCobsEncode(in, n, enc);
+    if (e > n + n / 254 + 1)
+        return false;
+    for (size_t i = 0; i < e; i++)
+        if (enc[i] == 0)
+            return false;
+    size_t d = telemCobsDecode(enc, e, dec, sizeof(dec));
+    return d == n && memcmp(in, dec, n) == 0;
+}
+
+void testCobs()
+{
+    static uint8_t b[1024];
+
+    // Empty, a lone zero, zeros at both ends and in a row.
+    CHECK(cobsRoundTrip(b, 0));
+    const uint8_t z1[] = {0};
+    CHECK(cobsRoundTrip(z1, 1));
+    const uint8_t z2[] = {0, 1, 2, 0, 0, 3, 0};
+    CHECK(cobsRoundTrip(z2, sizeof(z2)));
+
+    // Non-zero runs around the 254-byte block limit, with and without a
+    // zero after them.
+    static const size_t runs[] = {253, 254, 255, 508, 509, 1000};
+    for (size_t n : runs)
+    {
+        for (size_t i = 0; i < n; i++)
+            b[i] = (uint8_t)(i % 255 + 1);
+        CHECK(cobsRoundTrip(b, n));
+        b[n] = 0;
+        CHECK(cobsRoundTrip(b, n + 1));
+    }
+
+    // Every byte value, zeros included.
+    for (size_t i = 0; i < 1024; i++)
+        b[i] = (uint8_t)(i * 7);
+    CHECK(cobsRoundTrip(b, 1024));
+
+    // Malformed: a zero code, a block running past the end, no room.
+    const uint8_t bad1[] = {0, 1};
+    const uint8_t bad2[] = {5, 1, 2};
+    uint8_t out[4];
+    CHECK(telemCobsDecode(bad1, sizeof(bad1), out, sizeof(out)) == 0);
+    CHECK(telemCobsDecode(bad2, sizeof(bad2), out, sizeof(out)) == 0);
+    const uint8_t z3[] = {1, 2, 3, 4, 5, 6};
+    uint8_t enc[16];
+    size_t e = telemCobsEncode(z3, sizeof(z3), enc);
+    CHECK(telemCobsDecode(enc, e, out, sizeof(out)) == 0);
+}
+
+TelemetryRecord rec(uint16_t seq, uint32_t timeUs)
+{
+    TelemetryRecord r;
+    memset(&r, 0, sizeof(r));
+    r.version   = TELEM_VERSION;
+    r.size      = sizeof(r);
+    r.seq       = seq;
+    r.timeUs    = timeUs;
+    r.currentHz = 12000;
+    r.targetHz  = 0x00010000;     // Zero bytes in the payload
+    r.rpmX10    = 123456;
+    r.flags     = TF_RUNNING | TF_DIR_CW | TF_GAP;
+    return r;
+}
+
+// Frame 'r' and feed it to 'd' the way the decoder tool does (delimiter
+// stripped). Returns whether it was accepted.
+bool feed(TelemetryDecoder &d, const TelemetryRecord &r, TelemetryRecord *out = nullptr,
+          uint64_t *timeUs = nullptr)
+{
+    uint8_t f[TELEM_FRAME_MAX];
+    size_t n = telemEncodeFrame(r, f);
+    TelemetryRecord got;
+    uint64_t t;
+    bool ok = d.frame(f, n - 1, got, t);
+    if (out) *out = got;
+    if (timeUs) *timeUs = t;
+    return ok;
+}
+
+void testRecord()
+{
+    TelemetryRecord r = rec(42, 0xDEAD00BE), got;
+    uint8_t f[TELEM_FRAME_MAX];
+    size_t n = telemEncodeFrame(r, f);
+    CHECK(n <= TELEM_FRAME_MAX);
+    CHECK(f[n - 1] == 0);
+    bool zero = false;
+    for (size_t i = 0; i + 1 < n; i++)
+        zero |= f[i] == 0;
+    CHECK(!zero);
+
+    TelemetryDecoder d;
+    uint64_t t = 0;
+    CHECK(feed(d, r, &got, &t));
+    CHECK(memcmp(&r, &got, sizeof(r)) == 0);
+    CHECK(t == 0xDEAD00BE);
+
+    // Any flipped bit fails the CRC (or the framing).
+    for (size_t i = 0; i + 1 < n; i++)
+    {
+        uint8_t g[TELEM_FRAME_MAX];
+        memcpy(g, f, n);
+        g[i] ^= 0x10;
+        if (g[i] == 0)
+            continue;    // Would split the frame instead
+        TelemetryRecord x;
+        CHECK(!d.frame(g, n - 1, x, t));
+    }
+    CHECK(d.good == 1);
+
+    // Text on the line between frames is skipped.
+    const char *text = "boot: hello";
+    TelemetryRecord x;
+    CHECK(!d.frame((const uint8_t *)text, strlen(text), x, t));
+}
+
+// Only records of this version are taken, however well formed.
+void testVersion()
+{
+    TelemetryDecoder d;
+    static const uint8_t versions[] = {0, TELEM_VERSION + 1, 0xFF};
+    for (uint8_t v : versions)
+    {
+        TelemetryRecord r = rec(1, 100);
+        r.version = v;
+        CHECK(!feed(d, r));
+    }
+    CHECK(d.bad == 3);
+    CHECK(d.good == 0);
+    CHECK(feed(d, rec(1, 100)));
+}
+
+// Gaps are counted, seq and time wrap, and a step back is a restart.
+void testSequence()
+{
+    TelemetryDecoder d;
+    uint64_t t;
+    CHECK(feed(d, rec(10, 1000)));
+    CHECK(feed(d, rec(11, 2000)));
+    CHECK(feed(d, rec(15, 3000)));              // 12..14 lost
+    CHECK(d.missing == 3);
+
+    // Ahead by just under half the range is still a gap.
+    CHECK(feed(d, rec(15 + 32767, 4000)));
+    CHECK(d.missing == 3 + 32766);
+    CHECK(d.restarts == 0);
+
+    // Sequence wrap: 65535 -> 0 is one step; the time wraps too.
+    CHECK(feed(d, rec(65534, 0xFFFFFF00u)));
+    CHECK(feed(d, rec(65535, 0xFFFFFFF0u)));
+    CHECK(feed(d, rec(0, 0x10), nullptr, &t));
+    CHECK(d.restarts == 0);
+    CHECK(d.missing == 3 + 32766 + (65534 - 32782 - 1));
+    CHECK(t == (1ULL << 32) + 0x10);
+
+    // Reboot: seq and time start over. No missing records, new time base.
+    uint64_t missing = d.missing;
+    CHECK(feed(d, rec(0, 500), nullptr, &t));
+    CHECK(d.restarts == 1);
+    CHECK(d.missing == missing);
+    CHECK(t == 500);
+    CHECK(feed(d, rec(1, 600), nullptr, &t));
+    CHECK(t == 600);
+
+    // A reboot well into a run (seq back by a lot) as well.
+    CHECK(feed(d, rec(2000, 700)));
+    missing = d.missing;
+    CHECK(feed(d, rec(3, 50), nullptr, &t));
+    CHECK(d.restarts == 2);
+    CHECK(d.missing == missing);
+    CHECK(t == 50);
+    CHECK(d.good == 11);
+}
+
+} // namespace
+
+int main()
+{
+    testCrc();
+    testCobs();
+    testRecord();
+    testVersion();
+    testSequence();
+    return checkExit("test_telemetry");
+}
@@ -0,0 +1,77 @@
+// Decode a binary telemetry capture (Settings -> Telemetry: BINARY) to CSV.
+//
+// Build:  g++ -std=c++17 -O2 -o telemetry_decode tools/telemetry_decode.cpp
+// Use:    telemetry_decode capture.bin > capture.csv
+//         (or read stdin: cat /dev/ttyACM0 | telemetry_decode > live.csv)
+//
+// Frames are split on 0x00 and checked by TelemetryDecoder (length, CRC16,
+// version); anything else on the line (boot text, debug prints) fails the
+// check and is skipped, as is a record of another TELEM_VERSION. time_us
+// is unwrapped to 64 bits. A sequence number that goes back means the
+// device restarted: the time base starts over from that record. A summary
+// of good, bad and missing records and of restarts goes to stderr.
+#include <cstdio>
+#include <vector>
+#include "../src/ESP32-S3-MiniController/TelemetryFrame.h"
+
+namespace
+{
+
+void printRecord(const TelemetryRecord &r, uint64_t timeUs)
+{
+    unsigned f = r.flags;
+    printf("%u,%llu,%lu,%lu,%lu.%lu,0x%04x,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+           (unsigned)r.seq, (unsigned long long)timeUs,
+           (unsigned long)r.currentHz, (unsigned long)r.targetHz,
+           (unsigned long)(r.rpmX10 / 10), (unsigned long)(r.rpmX10 % 10), f,
+           !!(f & TF_RUNNING), !!(f & TF_STOPPING), !!(f & TF_DIR_CW), !!(f & TF_RAMPING),
+           !!(f & TF_CLOSED), !!(f & TF_LD), !!(f & TF_LD_TRIP), !!(f & TF_PERIOD),
+           (f & TF_SLIP_MASK) >> TF_SLIP_SHIFT, !!(f & TF_FG_LOSS), !!(f & TF_STALL),
+           !!(f & TF_MOVE), !!(f & TF_TEST), !!(f & TF_GAP));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    if (argc > 2 || (argc == 2 && !(in = fopen(argv[1], "rb"))))
+    {
+        fprintf(stderr, "usage: %s [capture.bin]\n", argv[0]);
+        return 1;
+    }
+
+    printf("seq,time_us,current_hz,target_hz,rpm,flags,running,stopping,dir_cw,ramping,"
+           "closed_loop,ld,ld_trip,period,slip,fg_loss,stall,move,test,gap\n");
+
+    TelemetryDecoder d;
+    std::vector<uint8_t> buf;
+    int c;
+    while ((c = fgetc(in)) != EOF)
+    {
+        if (c != 0)
+        {
+            // No frame is this long: it is line noise, resync on the next 0.
+            if (buf.size() < TELEM_FRAME_MAX + 256)
+                buf.push_back((uint8_t)c);
+            continue;
+        }
+        if (buf.size() > TELEM_FRAME_MAX + 255)
+            d.bad++;
+        else
+        {
+            TelemetryRecord r;
+            uint64_t timeUs;
+            if (d.frame(buf.data(), buf.size(), r, timeUs))
+                printRecord(r, timeUs);
+        }
+        buf.clear();
+    }
+    if (in != stdin)
+        fclose(in);
+
+    fprintf(stderr, "records: %llu, bad frames: %llu, missing (seq gaps): %llu, restarts: %llu\n",
+            (unsigned long long)d.good, (unsigned long long)d.bad, (unsigned long long)d.missing,
+            (unsigned long long)d.restarts);
+    return 0;
+}